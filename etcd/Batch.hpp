@@ -0,0 +1,160 @@
+#ifndef __ETCD_BATCH_HPP__
+#define __ETCD_BATCH_HPP__
+
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+
+/**
+ * Statistics of a batch pipeline.
+ */
+struct BatchStats {
+  size_t submitted = 0;
+  size_t completed = 0;
+  size_t failed = 0;
+  // from the first submission to the latest completion
+  std::chrono::microseconds elapsed = std::chrono::microseconds::zero();
+
+  /**
+   * Returns the completed operations per second.
+   */
+  double throughput() const;
+};
+
+/**
+ * Keeps up to `max_inflight` requests on the wire of the client's channel,
+ * rather than one round trip at a time, the common part of `BatchWriter` and
+ * `BatchReader`.
+ *
+ * Submitting blocks only when the window is full, by waiting for the oldest
+ * request. The results are reported in the order of submission, either to the
+ * callback, or (if no callback is given) collected and returned by `flush()`.
+ *
+ * A pipeline is not thread-safe, use one pipeline per thread.
+ */
+class BatchPipeline {
+ public:
+  /**
+   * The callback receives the index of the item (in the order of submission)
+   * and its response.
+   */
+  using Callback = std::function<void(size_t, Response const&)>;
+
+  BatchPipeline(BatchPipeline const&) = delete;
+  BatchPipeline(BatchPipeline&&) = delete;
+
+  /**
+   * Waits for the pending requests, the uncollected results are dropped.
+   */
+  virtual ~BatchPipeline();
+
+  /**
+   * Waits for all pending requests, and returns the results since the last
+   * flush (empty if a callback is given).
+   */
+  std::vector<Response> flush();
+
+  /**
+   * Returns the number of the pending requests.
+   */
+  size_t inflight() const { return pending.size(); }
+
+  /**
+   * Returns the statistics since the pipeline was created.
+   */
+  BatchStats const& stats() const { return statistics; }
+
+ protected:
+  BatchPipeline(SyncClient& client, size_t const max_inflight,
+                Callback const& callback);
+
+  // makes room in the window for a new request, and, if `ordered`, waits for
+  // the pending requests on the same key.
+  void prepare(std::string const& key, bool const ordered);
+
+  // records an issued request, returns the index of the item.
+  size_t submit(std::string const& key, std::function<Response()> const& wait);
+
+  SyncClient& client;
+
+ private:
+  struct Pending {
+    std::string key;
+    std::function<Response()> wait;
+  };
+
+  // waits for the oldest pending request
+  void complete_one();
+
+  size_t window;
+  Callback callback;
+
+  std::deque<Pending> pending;
+  std::map<std::string, size_t> pending_keys;
+  std::vector<Response> results;
+
+  std::chrono::steady_clock::time_point start_timepoint;
+  BatchStats statistics;
+};
+
+/**
+ * Pipelines puts and deletes, the writes on the same key are applied in the
+ * order of submission.
+ *
+ * @code
+ *   etcd::BatchWriter writer(client, 128);
+ *   for (...) {
+ *     writer.put(key, value);
+ *   }
+ *   std::vector<etcd::Response> results = writer.flush();
+ * @endcode
+ */
+class BatchWriter : public BatchPipeline {
+ public:
+  BatchWriter(Client const& client, size_t const max_inflight = 64,
+              Callback const& callback = nullptr);
+  BatchWriter(SyncClient& client, size_t const max_inflight = 64,
+              Callback const& callback = nullptr);
+
+  /**
+   * Submits a put, returns the index of the item.
+   */
+  size_t put(std::string const& key, std::string const& value,
+             const int64_t leaseId = 0);
+
+  /**
+   * Submits a delete, returns the index of the item.
+   */
+  size_t rm(std::string const& key);
+};
+
+/**
+ * Pipelines gets.
+ */
+class BatchReader : public BatchPipeline {
+ public:
+  BatchReader(Client const& client, size_t const max_inflight = 64,
+              Callback const& callback = nullptr);
+  BatchReader(SyncClient& client, size_t const max_inflight = 64,
+              Callback const& callback = nullptr);
+
+  /**
+   * Submits a get (at the given revision if positive), returns the index of
+   * the item.
+   */
+  size_t get(std::string const& key, int64_t revision = 0);
+};
+
+}  // namespace etcd
+
+#endif
@@ -2,11 +2,13 @@
 #define __ETCD_CLIENT_HPP__
 
 #include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "pplx/pplxtasks.h"
 
@@ -271,6 +273,37 @@ class Client {
    */
   pplx::task<Response> get(std::string const& key, int64_t revision);
 
+  /**
+   * Get the value of specified key from the etcd server, with the given
+   * consistency rather than the one of the client.
+   * @param key is the key to be read
+   * @param consistency is the consistency of the read
+   */
+  pplx::task<Response> get(std::string const& key,
+                           ReadConsistency consistency);
+
+  /**
+   * Get the value of specified key from the etcd server, if it matches the
+   * revision filters of the options.
+   * @param key is the key to be read
+   * @param options are the revision and filters of the read
+   */
+  pplx::task<Response> get(std::string const& key,
+                           RangeOptions const& options);
+
+  /**
+   * Get the values of many keys in a few round trips, see also
+   * `SyncClient::get_many()`.
+   *
+   * @param keys are the keys to be read
+   * @param max_ops is the maximum number of operations in a transaction
+   * @param max_inflight is the maximum number of transactions on the wire at
+   * the same time
+   */
+  pplx::task<std::vector<Response>> get_many(
+      std::vector<std::string> const& keys, size_t const max_ops = 128,
+      size_t const max_inflight = 16);
+
   /**
    * Sets the value of a key. The key will be modified if already exists or
    * created if it does not exists.
@@ -405,6 +438,32 @@ class Client {
   pplx::task<Response> rmdir(std::string const& key,
                              std::string const& range_end);
 
+  using DeleteProgress = SyncClient::DeleteProgress;
+
+  /**
+   * Removes the keys prefixed by the key in chunks of at most `chunk_size`
+   * keys, see also `SyncClient::rmdir_chunked()`.
+   *
+   * @param key is the prefix of the keys to be removed
+   * @param chunk_size is the maximum number of keys removed per request
+   * @param prev_kv whether to return the removed key-values (in `values()`)
+   * @param progress receives the number of keys deleted after each chunk
+   */
+  pplx::task<Response> rmdir_chunked(std::string const& key,
+                                     size_t const chunk_size = 1000,
+                                     bool const prev_kv = false,
+                                     DeleteProgress const& progress = nullptr);
+
+  /**
+   * Removes the keys between [key, range_end) in chunks of at most
+   * `chunk_size` keys, see also `SyncClient::rmdir_chunked()`.
+   */
+  pplx::task<Response> rmdir_chunked(std::string const& key,
+                                     std::string const& range_end,
+                                     size_t const chunk_size = 1000,
+                                     bool const prev_kv = false,
+                                     DeleteProgress const& progress = nullptr);
+
   /**
    * Gets a directory listing of the directory prefixed by the key.
    *
@@ -471,6 +530,46 @@ class Client {
   pplx::task<Response> ls(std::string const& key, std::string const& range_end,
                           size_t const limit, int64_t revision);
 
+  /**
+   * Gets a directory listing of the directory prefixed by the key, sorted and
+   * filtered by the etcd server as the options specify.
+   *
+   * @param key is the key to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  pplx::task<Response> ls(std::string const& key, RangeOptions const& options);
+
+  /**
+   * Gets a directory listing of the range [key, range_end), sorted and
+   * filtered by the etcd server as the options specify.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  pplx::task<Response> ls(std::string const& key, std::string const& range_end,
+                          RangeOptions const& options);
+
+  /**
+   * Gets a directory listing of the directory prefixed by the key, with the
+   * given consistency rather than the one of the client.
+   *
+   * @param key is the key to be listed
+   * @param consistency is the consistency of the read
+   */
+  pplx::task<Response> ls(std::string const& key, ReadConsistency consistency);
+
+  /**
+   * Gets a directory listing of the range [key, range_end), with the given
+   * consistency rather than the one of the client.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param consistency is the consistency of the read
+   */
+  pplx::task<Response> ls(std::string const& key, std::string const& range_end,
+                          ReadConsistency consistency);
+
   /**
    * Gets a directory listing of the directory prefixed by the key.
    *
@@ -546,6 +645,98 @@ class Client {
                             std::string const& range_end, size_t const limit,
                             int64_t revision);
 
+  /**
+   * List keys prefixed by the key, sorted and filtered by the etcd server as
+   * the options specify.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  pplx::task<Response> keys(std::string const& key,
+                            RangeOptions const& options);
+
+  /**
+   * List keys in the range [key, range_end), sorted and filtered by the etcd
+   * server as the options specify.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  pplx::task<Response> keys(std::string const& key,
+                            std::string const& range_end,
+                            RangeOptions const& options);
+
+  /**
+   * List keys prefixed by the key, with the given consistency rather than the
+   * one of the client.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param consistency is the consistency of the read
+   */
+  pplx::task<Response> keys(std::string const& key,
+                            ReadConsistency consistency);
+
+  /**
+   * List keys in the range [key, range_end), with the given consistency
+   * rather than the one of the client.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param consistency is the consistency of the read
+   */
+  pplx::task<Response> keys(std::string const& key,
+                            std::string const& range_end,
+                            ReadConsistency consistency);
+
+  /**
+   * Counts the keys prefixed by the key, without transferring any of them,
+   * see also `SyncClient::count()`.
+   *
+   * @param key is the prefix of the keys to be counted
+   */
+  pplx::task<Response> count(std::string const& key);
+
+  /**
+   * Counts the keys in the range [key, range_end), without transferring any
+   * of them, see also `SyncClient::count()`.
+   *
+   * @param key is the key to be counted
+   * @param range_end is the end of key range to be counted
+   */
+  pplx::task<Response> count(std::string const& key,
+                             std::string const& range_end);
+
+  /**
+   * Counts the keys prefixed by the key, with the given consistency rather
+   * than the one of the client.
+   *
+   * @param key is the prefix of the keys to be counted
+   * @param consistency is the consistency of the read
+   */
+  pplx::task<Response> count(std::string const& key,
+                             ReadConsistency consistency);
+
+  /**
+   * Counts the keys in the range [key, range_end), with the given consistency
+   * rather than the one of the client.
+   *
+   * @param key is the key to be counted
+   * @param range_end is the end of key range to be counted
+   * @param consistency is the consistency of the read
+   */
+  pplx::task<Response> count(std::string const& key,
+                             std::string const& range_end,
+                             ReadConsistency consistency);
+
   /**
    * Watches for changes of a key or a subtree. Please note that if you watch
    * e.g. "/testdir" and a new key is created, like "/testdir/newkey" then no
@@ -630,6 +821,32 @@ class Client {
    */
   pplx::task<Response> leases();
 
+  /**
+   * Grants many leases, with at most `max_inflight` requests on the wire at
+   * the same time, see also `SyncClient::leasegrant_batch()`.
+   */
+  pplx::task<std::vector<Response>> leasegrant_batch(
+      std::vector<int> const& ttls, size_t const max_inflight = 64);
+
+  /**
+   * Revokes many leases, see also `leasegrant_batch()`.
+   */
+  pplx::task<std::vector<Response>> leaserevoke_batch(
+      std::vector<int64_t> const& lease_ids, size_t const max_inflight = 64);
+
+  /**
+   * Gets the time-to-live of many leases, see also `leasegrant_batch()`.
+   */
+  pplx::task<std::vector<Response>> leasetimetolive_batch(
+      std::vector<int64_t> const& lease_ids, size_t const max_inflight = 64);
+
+  /**
+   * Lists all alive leases with their time-to-live, see also
+   * `SyncClient::leases_with_ttl()`.
+   */
+  pplx::task<std::vector<Response>> leases_with_ttl(
+      size_t const max_inflight = 64);
+
   /**
    * Add an etcd member to the etcd cluster, equivalent to `etcdctl member add`.
    * @param peer_urls is comma separated list of URLs for the new member.
@@ -731,6 +948,24 @@ class Client {
   pplx::task<Response> campaign(std::string const& name, int64_t lease_id,
                                 std::string const& value);
 
+  /**
+   * Campaign for the election @name@, which can be cancelled by the
+   * cancellation token.
+   *
+   * Unlike the overload above, the pending campaign doesn't occupy a thread
+   * of the task scheduler, the campaigns and observations of a client share
+   * one event loop.
+   *
+   * @param name is the name of election that will campaign for.
+   * @param lease_id is a user-managed (usually with a `KeepAlive`) lease id.
+   * @param value is the value for campaign.
+   * @param token cancels the pending campaign, the task will be completed with
+   *        an error response if cancelled before being elected.
+   */
+  pplx::task<Response> campaign(std::string const& name, int64_t lease_id,
+                                std::string const& value,
+                                pplx::cancellation_token const& token);
+
   /**
    * Updates the value of election with a new value, with leader key returns by
    * @campaign@.
@@ -766,6 +1001,22 @@ class Client {
    */
   std::unique_ptr<Observer> observe(std::string const& name);
 
+  using Executor = SyncClient::Executor;
+
+  /**
+   * Observe the leader change with a callback, see also
+   * `SyncClient::observe()`.
+   *
+   * @param name is the names of election to watch.
+   * @param callback will be invoked with every leader change.
+   * @param executor runs the callback, inline on the event loop if not given.
+   *
+   * @returns an observer that will cancel the observing when being destructed.
+   */
+  std::unique_ptr<Observer> observe(std::string const& name,
+                                    std::function<void(Response)> callback,
+                                    Executor const& executor = nullptr);
+
   /**
    * Updates the value of election with a new value, with leader key returns by
    * @campaign@.
@@ -808,12 +1059,59 @@ class Client {
     return this->client->get_grpc_timeout();
   }
 
+  /**
+   * Set the consistency of the range reads of this client, see also
+   * `SyncClient::set_read_consistency()`.
+   */
+  void set_read_consistency(ReadConsistency consistency) {
+    this->client->set_read_consistency(consistency);
+  }
+
+  /**
+   * Get the consistency of the range reads of this client.
+   */
+  ReadConsistency get_read_consistency() const {
+    return this->client->get_read_consistency();
+  }
+
+  /**
+   * Enable (or disable) coalescing of identical concurrent reads, see also
+   * `SyncClient::set_read_coalescing()`.
+   */
+  void set_read_coalescing(bool enabled) {
+    this->client->set_read_coalescing(enabled);
+  }
+
+  /**
+   * Whether coalescing of identical concurrent reads is enabled.
+   */
+  bool read_coalescing() const { return this->client->read_coalescing(); }
+
+  /**
+   * Returns the number of reads that were served by an identical in-flight
+   * read.
+   */
+  size_t read_coalescing_hits() const {
+    return this->client->read_coalescing_hits();
+  }
+
   /**
    * Obtain the underlying synchronous client.
    */
   SyncClient* sync_client() const;
 
  private:
+  // the asynchronous flavor of `SyncClient::coalesced_read()`, the identical
+  // reads share the in-flight one, rather than waiting for it in a thread each
+  pplx::task<Response> coalesced_read(
+      std::string const& signature,
+      std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+          make_call);
+  pplx::task<Response> coalesced_read(
+      std::string const& signature, ReadConsistency consistency,
+      std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+          make_call);
+
   bool own_client = true;
   SyncClient* client = nullptr;
 };
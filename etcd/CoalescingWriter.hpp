@@ -0,0 +1,124 @@
+#ifndef __ETCD_COALESCING_WRITER_HPP__
+#define __ETCD_COALESCING_WRITER_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+
+/**
+ * Coalesces concurrent writes into multi-operation transactions.
+ *
+ * The puts and deletes issued within `window` (counted from the first one of
+ * a batch), or up to `max_ops` of them, are submitted as one transaction
+ * without compares, i.e., one raft proposal and one round trip, and the
+ * response of each operation is delivered to the future of its caller.
+ *
+ * A transaction cannot touch a key twice, a write on a key that is already in
+ * the pending batch starts a new batch. Batches are committed one after
+ * another, thus the writes on the same key are applied in order.
+ *
+ * Note that the writes of a batch succeed or fail together.
+ */
+class CoalescingWriter {
+ public:
+  // see: `--max-txn-ops` of the etcd server
+  static const size_t DEFAULT_MAX_TXN_OPS = 128;
+
+  CoalescingWriter(Client const& client,
+                   std::chrono::microseconds const& window =
+                       std::chrono::microseconds(1000),
+                   size_t const max_ops = DEFAULT_MAX_TXN_OPS);
+  CoalescingWriter(SyncClient& client,
+                   std::chrono::microseconds const& window =
+                       std::chrono::microseconds(1000),
+                   size_t const max_ops = DEFAULT_MAX_TXN_OPS);
+
+  CoalescingWriter(CoalescingWriter const&) = delete;
+  CoalescingWriter(CoalescingWriter&&) = delete;
+
+  /**
+   * Commits the pending writes, and stops the writer.
+   */
+  ~CoalescingWriter();
+
+  /**
+   * Puts a key, the response is the same as `SyncClient::put()`.
+   */
+  std::future<Response> put(std::string const& key, std::string const& value,
+                            const int64_t leaseId = 0);
+
+  /**
+   * Removes a key, the response is the same as `SyncClient::rm()`.
+   */
+  std::future<Response> rm(std::string const& key);
+
+  /**
+   * Commits the pending writes without waiting for the rest of the window.
+   */
+  void flush();
+
+  /**
+   * Returns the number of the submitted transactions.
+   */
+  size_t transactions() const { return txns.load(); }
+
+  /**
+   * Returns the number of the coalesced writes.
+   */
+  size_t operations() const { return ops.load(); }
+
+ private:
+  struct Write {
+    bool is_put;
+    std::string key;
+    std::string value;
+    int64_t lease_id;
+    std::promise<Response> promise;
+  };
+
+  struct Batch {
+    std::chrono::steady_clock::time_point start_timepoint;
+    std::vector<Write> writes;
+    std::set<std::string> keys;
+  };
+
+  std::future<Response> enqueue(Write&& write);
+
+  void run();
+
+  void commit(Batch& batch);
+
+  SyncClient& client;
+  std::chrono::microseconds window;
+  size_t max_ops;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  // the last one is open for new writes, the others are sealed
+  std::deque<Batch> batches;
+  bool flushing = false;
+  bool stopped = false;
+
+  std::atomic<size_t> txns;
+  std::atomic<size_t> ops;
+
+  std::thread worker;
+};
+
+}  // namespace etcd
+
+#endif
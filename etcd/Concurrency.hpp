@@ -0,0 +1,297 @@
+#ifndef __ETCD_CONCURRENCY_HPP__
+#define __ETCD_CONCURRENCY_HPP__
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+class KeepAlive;
+
+/**
+ * Client-side concurrency recipes, the counterpart of the "concurrency"
+ * package of the etcd Go client.
+ *
+ * Unlike SyncClient::lock() and SyncClient::campaign(), which block inside the
+ * v3lock/v3election services on the server, the recipes are built on top of
+ * transactions and watches only: every contender creates a key under the
+ * prefix (guarded by a create-revision compare) with its session lease, and
+ * then watches the deletion of the key created right before it. Releasing
+ * wakes up exactly one waiter, and a blocked waiter can be cancelled locally.
+ */
+namespace concurrency {
+
+namespace detail {
+struct WaitState;
+}  // namespace detail
+
+/**
+ * The common part of the recipes: the session lease and the waiting on the
+ * predecessors.
+ */
+class Recipe {
+ public:
+  Recipe(Recipe const&) = delete;
+  Recipe(Recipe&&) = delete;
+
+  virtual ~Recipe();
+
+  /**
+   * Cancels the pending (or the next) blocking acquisition, which will return
+   * a response with error code ERROR_ACTION_CANCELLED.
+   */
+  void cancel();
+
+  /**
+   * Returns the lease of the session.
+   */
+  int64_t lease() const { return lease_id; }
+
+  /**
+   * Returns the key prefix of the recipe (with the trailing "/").
+   */
+  std::string const& prefix() const { return pfx; }
+
+ protected:
+  // creates a session lease with the default ttl and keeps it alive
+  Recipe(SyncClient& client, std::string const& prefix);
+  // reuses a session lease, the caller is responsible to keep it alive
+  Recipe(SyncClient& client, std::string const& prefix, int64_t lease_id);
+
+  // create `key` with the session lease if it doesn't exist yet, returns the
+  // create revision of the key (or the error response).
+  Response create_key(std::string const& key, std::string const& value,
+                      int64_t& create_revision);
+
+  // waits until all keys under `prefix` whose create revision is not larger
+  // than `max_create_revision` have been deleted, watching only the latest
+  // one of them each time.
+  Response wait_deletes(std::string const& prefix, int64_t max_create_revision,
+                        bool& waited);
+
+  // creates `key`, then waits until all keys under `wait_prefix` created
+  // before it have been deleted. The key will be removed if the waiting fails.
+  Response acquire(std::string const& key, std::string const& wait_prefix,
+                   int64_t& create_revision);
+
+  // waits until an event on [key, range_end) since `revision` satisfies the
+  // predicate, returns false if cancelled, or if the watch stopped (in which
+  // case `stopped` is set).
+  bool wait_event(std::string const& key, std::string const& range_end,
+                  int64_t revision,
+                  std::function<bool(Event const&)> const& predicate,
+                  bool& stopped);
+
+  // the first (or the last) created keys under the prefix
+  Response ls_by_create(std::string const& prefix, bool const first,
+                        bool const keys_only, int64_t max_create_revision = 0,
+                        size_t const limit = 1);
+
+  // returns true and resets the flag if the pending acquisition is cancelled
+  bool consume_cancelled();
+
+  Response make_response(
+      std::string const& action, int64_t index, std::string const& key,
+      std::chrono::high_resolution_clock::time_point const& start_timepoint)
+      const;
+  Response make_error(int error_code, std::string const& error_message) const;
+
+  SyncClient& client;
+  std::string pfx;
+
+ private:
+  // waits until the `key` has been deleted, returns false if cancelled
+  bool wait_delete(std::string const& key, int64_t revision);
+
+  std::shared_ptr<KeepAlive> session;
+  int64_t lease_id;
+  std::shared_ptr<detail::WaitState> state;
+};
+
+/**
+ * A distributed mutex, see also `concurrency.Mutex` in the etcd Go client.
+ *
+ * A session can hold the mutex on the same prefix at most once, i.e., mutexes
+ * sharing a session lease on the same prefix are the same mutex.
+ */
+class Mutex : public Recipe {
+ public:
+  Mutex(Client const& client, std::string const& prefix);
+  Mutex(SyncClient& client, std::string const& prefix);
+  Mutex(Client const& client, std::string const& prefix, int64_t lease_id);
+  Mutex(SyncClient& client, std::string const& prefix, int64_t lease_id);
+
+  /**
+   * Acquires the mutex, blocks until the mutex is held or cancelled.
+   *
+   * The returned response contains the key of the holder in `lock_key()`.
+   */
+  Response lock();
+
+  /**
+   * Releases the mutex.
+   */
+  Response unlock();
+
+  /**
+   * Returns the key of this contender.
+   */
+  std::string const& key() const { return my_key; }
+
+  /**
+   * Returns the create revision of the key of this contender, or 0 if not
+   * contending.
+   */
+  int64_t revision() const { return my_revision; }
+
+ private:
+  std::string my_key;
+  int64_t my_revision = 0;
+};
+
+/**
+ * A distributed read-write mutex, see also `recipe.RWMutex` in the etcd Go
+ * client.
+ *
+ * Readers only wait for the writers ahead of them, thus proceed in parallel,
+ * and writers wait for all readers and writers ahead of them. Readers and
+ * writers are queued under "<prefix>/read/" and "<prefix>/write/".
+ */
+class RWMutex : public Recipe {
+ public:
+  RWMutex(Client const& client, std::string const& prefix);
+  RWMutex(SyncClient& client, std::string const& prefix);
+  RWMutex(Client const& client, std::string const& prefix, int64_t lease_id);
+  RWMutex(SyncClient& client, std::string const& prefix, int64_t lease_id);
+
+  /**
+   * Acquires the mutex for reading, blocks until held or cancelled.
+   */
+  Response rlock();
+
+  /**
+   * Releases the mutex held for reading.
+   */
+  Response runlock();
+
+  /**
+   * Acquires the mutex for writing, blocks until held or cancelled.
+   */
+  Response lock();
+
+  /**
+   * Releases the mutex held for writing.
+   */
+  Response unlock();
+
+ private:
+  std::string read_key;
+  std::string write_key;
+  int64_t read_revision = 0;
+  int64_t write_revision = 0;
+};
+
+/**
+ * A distributed counting semaphore: at most `capacity` contenders hold it at
+ * the same time, in the order of their arrival.
+ *
+ * Only the first waiter watches the holders, and the other waiters watch their
+ * immediate predecessor, i.e., a release wakes up one waiter only. A new
+ * holder always touches its key to wake up its successor.
+ */
+class Semaphore : public Recipe {
+ public:
+  Semaphore(Client const& client, std::string const& prefix,
+            size_t const capacity);
+  Semaphore(SyncClient& client, std::string const& prefix,
+            size_t const capacity);
+  Semaphore(Client const& client, std::string const& prefix,
+            size_t const capacity, int64_t lease_id);
+  Semaphore(SyncClient& client, std::string const& prefix,
+            size_t const capacity, int64_t lease_id);
+
+  /**
+   * Acquires the semaphore, blocks until held or cancelled.
+   */
+  Response acquire();
+
+  /**
+   * Releases the semaphore.
+   */
+  Response release();
+
+  /**
+   * Returns the capacity of the semaphore.
+   */
+  size_t capacity() const { return cap; }
+
+  /**
+   * Returns the key of this contender.
+   */
+  std::string const& key() const { return my_key; }
+
+ private:
+  size_t cap;
+  std::string my_key;
+  int64_t my_revision = 0;
+};
+
+/**
+ * A leader election, see also `concurrency.Election` in the etcd Go client.
+ */
+class Election : public Recipe {
+ public:
+  Election(Client const& client, std::string const& prefix);
+  Election(SyncClient& client, std::string const& prefix);
+  Election(Client const& client, std::string const& prefix, int64_t lease_id);
+  Election(SyncClient& client, std::string const& prefix, int64_t lease_id);
+
+  /**
+   * Puts a value as eligible for the election, blocks until it is elected or
+   * cancelled.
+   *
+   * @param value is the value to proclaim once elected.
+   */
+  Response campaign(std::string const& value);
+
+  /**
+   * Lets the leader announce a new value without another election.
+   */
+  Response proclaim(std::string const& value);
+
+  /**
+   * Lets the leader start a new election.
+   */
+  Response resign();
+
+  /**
+   * Returns the current leader, the key and the proclaimed value are
+   * available in `value()` of the response.
+   */
+  Response leader();
+
+  /**
+   * Returns the key of the leader if elected, otherwise empty.
+   */
+  std::string const& key() const { return leader_key; }
+
+  /**
+   * Returns the create revision of the leader key if elected, otherwise 0.
+   */
+  int64_t revision() const { return leader_revision; }
+
+ private:
+  std::string leader_key;
+  int64_t leader_revision = 0;
+};
+
+}  // namespace concurrency
+}  // namespace etcd
+
+#endif
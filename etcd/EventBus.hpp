@@ -0,0 +1,170 @@
+#ifndef __ETCD_EVENT_BUS_HPP__
+#define __ETCD_EVENT_BUS_HPP__
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+class Watcher;
+
+/**
+ * Fans out a single watch of a prefix to any number of in-process
+ * subscribers, e.g., for modules that would otherwise each watch the same
+ * (or overlapping) prefixes, and receive and parse the same events again.
+ *
+ * A subscriber subscribes to a prefix under the prefix of the bus, and the
+ * events are routed to the subscribers by the key through a trie of their
+ * prefixes, thus the cost of an event doesn't depend on the number of
+ * subscribers that don't want it. Each subscriber has its own queue and
+ * thread, a slow subscriber doesn't hold up the others (nor the watch), and
+ * receives a response per revision, with the events of the revision under
+ * its prefix.
+ *
+ * The bus keeps the events of the latest `history` revisions, a subscriber
+ * that subscribes late can ask for a replay from a revision in the history,
+ * and then continues with the live events without a gap.
+ *
+ * The watch is resumed from the revision the bus has caught up with when
+ * interrupted. If that revision has been compacted, the bus watches from the
+ * current revision, and the subscribers are told about the gap with an error
+ * response.
+ *
+ * The bus must outlive its subscriptions.
+ */
+class EventBus {
+ public:
+  static const size_t DEFAULT_HISTORY = 1024;
+
+ private:
+  struct Subscriber;
+
+ public:
+  /**
+   * Receives the events of the bus until destructed.
+   */
+  class Subscription {
+   public:
+    /**
+     * Unsubscribes, the undelivered responses are dropped. Waits for the
+     * callback to return, thus don't destroy a subscription inside its own
+     * callback.
+     */
+    ~Subscription();
+
+    /**
+     * Returns the number of responses waiting in the queue.
+     */
+    size_t pending() const;
+
+   private:
+    friend class EventBus;
+    Subscription(EventBus* bus, std::shared_ptr<Subscriber> const& subscriber)
+        : bus(bus), subscriber(subscriber) {}
+
+    EventBus* bus;
+    std::shared_ptr<Subscriber> subscriber;
+  };
+
+  EventBus(Client const& client, std::string const& prefix,
+           size_t const history = DEFAULT_HISTORY);
+  EventBus(SyncClient& client, std::string const& prefix,
+           size_t const history = DEFAULT_HISTORY);
+
+  EventBus(EventBus const&) = delete;
+  EventBus(EventBus&&) = delete;
+
+  /**
+   * Stops watching.
+   */
+  ~EventBus();
+
+  /**
+   * Subscribes to the events of the keys with the given prefix, which must
+   * be under the prefix of the bus, otherwise returns nullptr.
+   *
+   * If `from_revision` is positive, the events since that revision are
+   * replayed from the history first. If the revision is older than the
+   * history, the callback receives an error response instead, followed by
+   * the live events.
+   */
+  std::unique_ptr<Subscription> subscribe(
+      std::string const& prefix, std::function<void(Response)> callback,
+      int64_t const from_revision = 0);
+
+  /**
+   * Returns the revision that the bus has caught up with, which also moves
+   * with the writes outside the prefix as the watch reports its progress
+   * (periodically).
+   */
+  int64_t revision() const;
+
+  /**
+   * Returns the oldest revision that can be replayed.
+   */
+  int64_t history_revision() const;
+
+  /**
+   * Returns the number of subscriptions.
+   */
+  size_t subscribers() const;
+
+ private:
+  struct Node;
+  struct NodeDeleter {
+    void operator()(Node* node);
+  };
+
+  // removes a subscriber from the trie
+  void unsubscribe(std::shared_ptr<Subscriber> const& subscriber);
+
+  // routes the events of a watch response to the subscribers
+  void apply(Response const& resp);
+
+  // catches up with a progress notification of the watch
+  void advance(int64_t const revision);
+
+  // tells all subscribers about a gap in the events, with the lock held
+  void broadcast(Response const& resp);
+
+  // (re)starts the watcher from the revision the bus has caught up with,
+  // returns false if it cannot be started
+  bool watch();
+
+  // restarts the watcher once interrupted
+  void run();
+
+  SyncClient& client;
+  std::string prefix;
+  size_t history;
+
+  mutable std::mutex mutex;
+  // the trie of the prefixes of the subscribers
+  std::unique_ptr<Node, NodeDeleter> root;
+  size_t subscriber_count = 0;
+  // the events of the latest revisions, a response per revision
+  std::deque<Response> recent;
+  // the events since this revision are all in `recent`
+  int64_t history_start = 0;
+  int64_t watched_revision = 0;
+
+  // shared with the wait callbacks of watchers, which may run after the
+  // watcher (and the bus) has gone
+  struct Signal;
+  std::shared_ptr<Signal> signal;
+
+  std::unique_ptr<Watcher> watcher;
+  std::thread worker;
+};
+
+}  // namespace etcd
+
+#endif
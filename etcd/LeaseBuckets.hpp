@@ -0,0 +1,98 @@
+#ifndef __ETCD_LEASE_BUCKETS_HPP__
+#define __ETCD_LEASE_BUCKETS_HPP__
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+
+/**
+ * Shares leases among keys with a TTL.
+ *
+ * Attaching a dedicated lease to every key costs a `leasegrant` for each key
+ * and keeps the lessor of the server busy. LeaseBuckets groups the keys whose
+ * expirations fall into the same time window of `granularity` and attaches
+ * them to one lease of the window, which is granted on the first use, and
+ * forgotten (the server expires it) once the window is over.
+ *
+ * The precision of expiration is traded for less leases: a key put with `ttl`
+ * expires after at least `ttl` seconds, and at most `ttl + granularity`
+ * seconds.
+ */
+class LeaseBuckets {
+ public:
+  LeaseBuckets(Client const& client, std::chrono::seconds const& granularity);
+  LeaseBuckets(SyncClient& client, std::chrono::seconds const& granularity);
+
+  LeaseBuckets(LeaseBuckets const&) = delete;
+  LeaseBuckets(LeaseBuckets&&) = delete;
+
+  /**
+   * The leases are not revoked, the keys will expire as scheduled.
+   */
+  ~LeaseBuckets() = default;
+
+  /**
+   * Finds (or grants) the lease of the bucket for keys that should expire
+   * after `ttl` seconds.
+   *
+   * @param ttl is the minimum time-to-live of the key, in seconds.
+   * @param lease_id is set to the lease of the bucket if succeed.
+   *
+   * @returns the error response of `leasegrant` if failed.
+   */
+  Response lease(int ttl, int64_t& lease_id);
+
+  /**
+   * Puts a key that expires after (at least) `ttl` seconds.
+   */
+  Response put(std::string const& key, std::string const& value, int ttl);
+
+  /**
+   * Creates a key that expires after (at least) `ttl` seconds, fails if the
+   * key already exists.
+   */
+  Response add(std::string const& key, std::string const& value, int ttl);
+
+  /**
+   * Forgets the bucket of the lease, e.g., when the lease has been revoked.
+   */
+  void forget(int64_t lease_id);
+
+  /**
+   * Returns the number of the live buckets (i.e., the live leases).
+   */
+  size_t size();
+
+  /**
+   * Returns the width of the time window of a bucket.
+   */
+  std::chrono::seconds granularity() const { return window; }
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  // drops the buckets whose window has passed, requires the lock
+  void rollover(clock_type::time_point const& now);
+
+  template <typename F>
+  Response with_lease(int ttl, F const& fn);
+
+  SyncClient& client;
+  std::chrono::seconds window;
+
+  std::mutex mutex;
+  // the leases, indexed by the end of their time window
+  std::map<clock_type::time_point, int64_t> buckets;
+};
+
+}  // namespace etcd
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef __ETCD_MULTI_KEY_WATCHER_HPP__
+#define __ETCD_MULTI_KEY_WATCHER_HPP__
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+
+/**
+ * Watches a (possibly large and changing) set of unrelated keys and ranges
+ * on a single watch stream, rather than a `Watcher` (and a stream) per key.
+ *
+ * The keys and ranges are merged into the minimal set of disjoint ranges,
+ * e.g., the keys `/a/1` and `/a/1\0` make a single range, and a key inside
+ * a range is not watched twice. Each merged range is a watch (with its own
+ * watch id) on the shared stream, and a response is routed to its range by
+ * a hash lookup of the watch id, thus the cost of an event doesn't depend on
+ * the number of watched keys.
+ *
+ * Keys and ranges can be added and removed at any time, which replaces the
+ * affected watches on the same stream. A replacing watch starts from the
+ * current revision, and the replaced ones keep delivering the events up to
+ * that revision until they have caught up with it (as told by their events,
+ * their progress notifications, or the progress of the stream, which is
+ * requested after replacing them), and are cancelled then. Thus no event of
+ * a key that stays watched is lost or delivered twice, a replacing watch
+ * never starts from a revision that may have been compacted, and a key that
+ * is added is watched from the revision of the cluster when it is added.
+ *
+ * The callback runs in the thread of the stream, with the events of one
+ * merged range per response. The events of a range are in revision order,
+ * the ones of different ranges are not ordered with each other. When the
+ * stream fails (or a revision has been compacted), the callback is invoked
+ * with an error response once, and the watcher stops.
+ *
+ * Don't destroy the watcher inside its callback.
+ */
+class MultiKeyWatcher {
+ public:
+  MultiKeyWatcher(Client const& client, std::function<void(Response)> callback);
+  MultiKeyWatcher(SyncClient& client, std::function<void(Response)> callback);
+
+  /**
+   * Watches the given keys, and the given ranges [key, range_end).
+   */
+  MultiKeyWatcher(
+      Client const& client, std::vector<std::string> const& keys,
+      std::vector<std::pair<std::string, std::string>> const& ranges,
+      std::function<void(Response)> callback);
+  MultiKeyWatcher(
+      SyncClient& client, std::vector<std::string> const& keys,
+      std::vector<std::pair<std::string, std::string>> const& ranges,
+      std::function<void(Response)> callback);
+
+  MultiKeyWatcher(MultiKeyWatcher const&) = delete;
+  MultiKeyWatcher(MultiKeyWatcher&&) = delete;
+
+  /**
+   * Cancels the stream, and waits for the callback to finish.
+   */
+  ~MultiKeyWatcher();
+
+  /**
+   * Starts watching a key, or the range [key, range_end) (the keys not less
+   * than `key` if `range_end` is "\0"). Returns false if the watcher has
+   * stopped, or the revision to watch from cannot be determined.
+   */
+  bool add(std::string const& key);
+  bool add(std::string const& key, std::string const& range_end);
+
+  /**
+   * Starts watching the given keys and ranges at once.
+   */
+  bool add(std::vector<std::string> const& keys,
+           std::vector<std::pair<std::string, std::string>> const& ranges);
+
+  /**
+   * Stops watching a key, or a range, that has been added before. A key that
+   * is covered by another added range is still watched. Returns false if the
+   * key (or range) has not been added.
+   */
+  bool remove(std::string const& key);
+  bool remove(std::string const& key, std::string const& range_end);
+
+  /**
+   * Returns the number of added keys and ranges.
+   */
+  size_t size() const;
+
+  /**
+   * Returns the number of watches on the stream, i.e., the merged ranges.
+   */
+  size_t watches() const;
+
+  /**
+   * Returns the number of replaced watches that haven't caught up yet, and
+   * thus are still on the stream.
+   */
+  size_t replaced() const;
+
+  /**
+   * Waits until the watcher stops, returns true if it has been cancelled
+   * rather than failed.
+   */
+  bool Wait();
+
+  /**
+   * Stops watching.
+   */
+  void Cancel();
+
+  /**
+   * Whether the watcher has stopped.
+   */
+  bool Stopped() const;
+
+ private:
+  // the ranges are [begin, end), an empty end means the end of the keyspace
+  using Range = std::pair<std::string, std::string>;
+
+  struct Watch {
+    int64_t id;
+    Range range;
+    // the revision that the watch has caught up with, i.e., of the last
+    // event, or progress notification
+    int64_t revision;
+    // a replaced watch delivers the events up to this revision, and the
+    // replacing ones the rest, 0 if not replaced
+    int64_t retire_at = 0;
+  };
+
+  struct Stream;
+  struct StreamDeleter {
+    void operator()(Stream* stream);
+  };
+
+  // the range of a key, or of [key, range_end)
+  static Range to_range(std::string const& key, std::string const& range_end);
+
+  // updates the watches after the added ranges have changed, with the lock
+  // held; the new watches start after `revision` (or the latest revision seen
+  // on the stream, if later)
+  void reconcile(int64_t const revision);
+
+  // cancels a replaced watch once it has caught up, with the lock held
+  void maybe_retire(std::shared_ptr<Watch> const& watch);
+
+  // whether a key is in the merged ranges, with the lock held
+  bool covers(std::string const& key) const;
+
+  // the event loop of the stream
+  void run();
+  // handles the response that has been read, with the lock held, returns
+  // true if `resp` is to be delivered
+  bool dispatch(Response& resp);
+
+  SyncClient& client;
+  std::function<void(Response)> callback;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  // the added ranges, with the number of times each has been added
+  std::map<Range, size_t> added;
+  // the merged ranges, by the begin key
+  std::map<std::string, std::shared_ptr<Watch>> merged;
+  // the watches on the stream (including the replaced ones that haven't
+  // caught up yet), by the watch id
+  std::unordered_map<int64_t, std::shared_ptr<Watch>> watches_by_id;
+  int64_t next_watch_id = 1;
+  // the latest revision in the headers of the responses
+  int64_t stream_revision = 0;
+  bool stopped = false;
+  bool cancelled = false;
+
+  std::unique_ptr<Stream, StreamDeleter> stream;
+  std::thread worker;
+};
+
+}  // namespace etcd
+
+#endif
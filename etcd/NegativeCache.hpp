@@ -0,0 +1,140 @@
+#ifndef __ETCD_NEGATIVE_CACHE_HPP__
+#define __ETCD_NEGATIVE_CACHE_HPP__
+
+#include <atomic>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+class Watcher;
+
+/**
+ * Remembers the keys under a prefix that don't exist, and answers `get()` of
+ * such keys locally with `ERROR_KEY_NOT_FOUND`, e.g., for probes of feature
+ * flags that mostly don't exist.
+ *
+ * The cache watches the prefix, and forgets a key as soon as the watch
+ * delivers a put of it. A key is only remembered if the revision of the "not
+ * found" response is not behind the watch, thus a put that races with the
+ * read is never missed. When the watch is interrupted, all keys are
+ * forgotten, and the watch is restarted by the next `get()`.
+ *
+ * The cache is bounded by the number of keys, and (approximately) by the
+ * bytes they take, the least recently used keys are evicted first.
+ *
+ * Reads of the keys outside of the prefix, and of the keys that exist, go to
+ * the server as usual.
+ */
+class NegativeCache {
+ public:
+  static const size_t DEFAULT_MAX_KEYS = 100000;
+  static const size_t DEFAULT_MAX_BYTES = 16 * 1024 * 1024;
+
+  NegativeCache(Client const& client, std::string const& prefix,
+                size_t const max_keys = DEFAULT_MAX_KEYS,
+                size_t const max_bytes = DEFAULT_MAX_BYTES);
+  NegativeCache(SyncClient& client, std::string const& prefix,
+                size_t const max_keys = DEFAULT_MAX_KEYS,
+                size_t const max_bytes = DEFAULT_MAX_BYTES);
+
+  NegativeCache(NegativeCache const&) = delete;
+  NegativeCache(NegativeCache&&) = delete;
+
+  /**
+   * Stops watching.
+   */
+  ~NegativeCache();
+
+  /**
+   * Gets a key, the response is the same as `SyncClient::get()`. For a key
+   * that is known to be absent, the index of the response is the revision
+   * that the watch has caught up with.
+   */
+  Response get(std::string const& key);
+
+  /**
+   * Whether the key is known to be absent.
+   */
+  bool absent(std::string const& key);
+
+  /**
+   * Forgets all keys.
+   */
+  void clear();
+
+  /**
+   * Returns the number of keys that are known to be absent.
+   */
+  size_t size() const;
+
+  /**
+   * Returns the (approximate) bytes taken by the keys.
+   */
+  size_t bytes() const;
+
+  /**
+   * Returns the number of reads answered locally.
+   */
+  size_t hits() const { return this->hit_count.load(); }
+
+  /**
+   * Returns the number of reads of keys under the prefix that went to the
+   * server.
+   */
+  size_t misses() const { return this->miss_count.load(); }
+
+ private:
+  // the estimated bookkeeping cost of a key, besides its bytes
+  static const size_t ENTRY_OVERHEAD = 64;
+
+  // whether the key is under the prefix
+  bool covers(std::string const& key) const;
+
+  // (re)starts the watcher if it has been interrupted, returns false if it
+  // cannot be started
+  bool ensure_watching();
+
+  // remembers an absent key, read at the given revision
+  void remember(std::string const& key, int64_t const revision);
+
+  // forgets the keys that have been put
+  void apply(Response const& resp);
+
+  SyncClient& client;
+  std::string prefix;
+  size_t max_keys;
+  size_t max_bytes;
+
+  mutable std::mutex mutex;
+  // the least recently used key first
+  std::list<std::string> lru;
+  std::unordered_map<std::string, std::list<std::string>::iterator> entries;
+  size_t used_bytes = 0;
+  // the revision that the watch has caught up with
+  int64_t watched_revision = 0;
+  bool watching = false;
+
+  std::atomic<size_t> hit_count{0};
+  std::atomic<size_t> miss_count{0};
+
+  // shared with the wait callbacks of watchers, which may run after the
+  // watcher (and the cache) has gone
+  struct Signal;
+  std::shared_ptr<Signal> signal;
+
+  // serializes (re)starting the watcher
+  std::mutex watch_mutex;
+  std::unique_ptr<Watcher> watcher;
+};
+
+}  // namespace etcd
+
+#endif
@@ -0,0 +1,313 @@
+#ifndef __ETCD_PREFIX_CACHE_HPP__
+#define __ETCD_PREFIX_CACHE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "etcd/RadixTree.hpp"
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+#include "etcd/Value.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+class Watcher;
+
+/**
+ * Mirrors the keys with a prefix in memory, and serves reads locally rather
+ * than with a round trip to the etcd server.
+ *
+ * The cache loads the prefix (page by page, see also `RangeIterator`) at
+ * some revision R, and then follows a watcher from R + 1 to apply the changes
+ * in order. Reads reflect the state of the prefix at `revision()`, which may
+ * lag behind the server by the latency of the watch. The revision moves with
+ * the writes outside the prefix as well, once the watch reports its progress
+ * (periodically, and when waiting for a revision, see `wait_for()`).
+ *
+ * When the watch is interrupted, e.g., the revision to resume from has been
+ * compacted, or the connection is lost, the cache reloads the prefix and
+ * resumes watching from the revision of the reload. Reads are served from the
+ * previous state in the meantime.
+ *
+ * The cached keys are published as immutable snapshots: the watch thread
+ * builds the next snapshot from the current one, copying only the chunks
+ * (radix trees of consecutive keys, see also `RadixTree`) touched by the
+ * events and sharing the rest, and swaps it in atomically.
+ * Readers never take a lock, nor wait for the watch thread, and a snapshot
+ * (see also `snapshot()`) stays unchanged for as long as it is held.
+ *
+ * Each reading thread keeps a reference to the last snapshot it has read
+ * from each cache, thus a replaced snapshot is released once every thread
+ * that has read it reads from the cache again, and the snapshot of a
+ * destroyed cache once the thread picks up a new snapshot of another cache.
+ *
+ * @code
+ *   etcd::PrefixCache cache(client, "/config/");
+ *   std::string value;
+ *   if (cache.get("/config/feature", value)) {
+ *     ...
+ *   }
+ * @endcode
+ */
+class PrefixCache {
+ public:
+  /**
+   * The state of the prefix at some revision, immutable.
+   */
+  class Snapshot {
+   private:
+    using Chunk = RadixTree;
+
+   public:
+    /**
+     * Iterates the values in key order, a value is valid until the iterator
+     * moves.
+     */
+    class const_iterator {
+     public:
+      Value const& operator*() const { return *position; }
+      Value const* operator->() const { return &*position; }
+      const_iterator& operator++();
+      bool operator==(const_iterator const& other) const {
+        return chunk == other.chunk && position == other.position;
+      }
+      bool operator!=(const_iterator const& other) const {
+        return !(*this == other);
+      }
+
+     private:
+      friend class Snapshot;
+      const_iterator(std::vector<std::shared_ptr<Chunk>> const* chunks,
+                     size_t const chunk, Chunk::const_iterator const& position)
+          : chunks(chunks), chunk(chunk), position(position) {}
+
+      std::vector<std::shared_ptr<Chunk>> const* chunks;
+      size_t chunk;
+      Chunk::const_iterator position;
+    };
+
+    /**
+     * Returns the revision the snapshot reflects.
+     */
+    int64_t revision() const { return this->snapshot_revision; }
+
+    /**
+     * Returns the number of keys in the snapshot.
+     */
+    size_t size() const { return this->entries; }
+
+    /**
+     * Reads a value, returns false if the key does not exist.
+     */
+    bool get(std::string const& key, std::string& value) const;
+
+    /**
+     * Reads a value, in the same form as `SyncClient::get()`, the index of the
+     * response is the revision of the snapshot.
+     */
+    Response get(std::string const& key) const;
+
+    /**
+     * Lists the keys with the given prefix (all keys if empty), in the same
+     * form as `SyncClient::ls()`.
+     */
+    Response ls(std::string const& prefix = "") const;
+
+    /**
+     * Lists the keys in the range [key, range_end), with the same semantics
+     * as `SyncClient::ls(key, range_end)`: an empty range end lists the key
+     * only, and a range end of "\0" lists all keys that are not less than
+     * `key`.
+     */
+    Response ls(std::string const& key, std::string const& range_end) const;
+
+    const_iterator begin() const;
+    const_iterator end() const {
+      return const_iterator(&chunks, chunks.size(), Chunk::const_iterator());
+    }
+
+    /**
+     * Returns the first value whose key is not less than the given key.
+     */
+    const_iterator lower_bound(std::string const& key) const;
+
+   private:
+    friend class PrefixCache;
+
+    // the number of keys per chunk, a chunk is split when it grows to twice
+    // as large
+    static const size_t CHUNK_SIZE = 512;
+
+    // the chunk that the key belongs to
+    size_t locate(std::string const& key) const;
+
+    // appends a key that is greater than all keys in the snapshot
+    void append(Value const& value);
+
+    // non-empty chunks of consecutive keys, shared with the previous and the
+    // following snapshots unless modified
+    std::vector<std::shared_ptr<Chunk>> chunks;
+    int64_t snapshot_revision = 0;
+    size_t entries = 0;
+  };
+
+  /**
+   * Loads the prefix (all keys if empty) and starts watching. If the initial
+   * load fails, the cache is empty (`revision()` is 0) until a retry
+   * succeeds.
+   */
+  PrefixCache(Client const& client, std::string const& prefix);
+  PrefixCache(SyncClient& client, std::string const& prefix);
+
+  /**
+   * Starts from the snapshot saved in the given file (see also `save()`) if
+   * any, and resumes watching from its revision, rather than loading the
+   * prefix from the server. The cache falls back to loading the prefix if the
+   * file is missing or invalid, was saved for another prefix, or the revision
+   * has been compacted.
+   *
+   * The snapshot is saved to the file again when the cache is destroyed,
+   * unless the file holds the snapshot of another prefix.
+   */
+  PrefixCache(Client const& client, std::string const& prefix,
+              std::string const& snapshot_path);
+  PrefixCache(SyncClient& client, std::string const& prefix,
+              std::string const& snapshot_path);
+
+  PrefixCache(PrefixCache const&) = delete;
+  PrefixCache(PrefixCache&&) = delete;
+
+  /**
+   * Stops watching, and saves the snapshot if a snapshot file is given (and
+   * doesn't hold the snapshot of another prefix).
+   */
+  ~PrefixCache();
+
+  /**
+   * Saves the current snapshot (keys, values, revisions and the revision of
+   * the snapshot) to a file, replacing it atomically. Returns false if the
+   * file cannot be written, or nothing has been loaded yet.
+   *
+   * The file is in the byte order of the host, and is meant to be read back
+   * by the same machine.
+   */
+  bool save(std::string const& path) const;
+
+  /**
+   * Returns the current snapshot, for a consistent view across several reads.
+   */
+  std::shared_ptr<const Snapshot> snapshot() const;
+
+  /**
+   * Reads a value from the cache, returns false if the key does not exist.
+   */
+  bool get(std::string const& key, std::string& value) const;
+
+  /**
+   * Reads a value from the cache, in the same form as `SyncClient::get()`,
+   * the index of the response is the revision of the cache.
+   */
+  Response get(std::string const& key) const;
+
+  /**
+   * Lists the cached keys with the given prefix (all cached keys if empty), in
+   * the same form as `SyncClient::ls()`.
+   */
+  Response ls(std::string const& prefix = "") const;
+
+  /**
+   * Lists the cached keys in the range [key, range_end), in the same form as
+   * `SyncClient::ls(key, range_end)`.
+   */
+  Response ls(std::string const& key, std::string const& range_end) const;
+
+  /**
+   * Returns the number of cached keys.
+   */
+  size_t size() const;
+
+  /**
+   * Returns the revision that the cache reflects, 0 before the first load.
+   */
+  int64_t revision() const;
+
+  /**
+   * Waits until the cache reflects (at least) the given revision, e.g., the
+   * revision of a write, returns false on timeout.
+   *
+   * The revision of a write outside the prefix is reached with the progress
+   * of the watch, which etcd servers before v3.4 only report periodically.
+   */
+  bool wait_for(int64_t revision, std::chrono::milliseconds const& timeout);
+
+  /**
+   * Returns the number of reloads, after the watch was interrupted or the
+   * initial load failed.
+   */
+  size_t resyncs() const { return this->resync_count.load(); }
+
+ private:
+  // loads the prefix and starts a watcher from the next revision
+  bool sync();
+
+  // loads the snapshot file and starts a watcher from the next revision
+  bool restore();
+
+  // stops the current watcher, returns the generation of the next one
+  size_t unwatch();
+
+  // starts a watcher from the revision after the given one
+  void watch(size_t const generation, int64_t const revision);
+
+  // applies the events of a watch response
+  void apply(Response const& resp);
+
+  // moves the revision with a progress notification of the watch
+  void advance(int64_t const revision);
+
+  // swaps in the next snapshot
+  void publish(std::shared_ptr<const Snapshot> const& next);
+
+  // the current snapshot, cached per thread and per cache until a new one is
+  // published, valid until the next call on the same thread
+  Snapshot const& acquire() const;
+
+  // reloads the prefix when requested
+  void run();
+
+  SyncClient& client;
+  std::string prefix;
+  std::string snapshot_path;
+
+  // identifies the cache in the per-thread snapshots
+  const uint64_t id;
+
+  // only accessed with std::atomic_load() and std::atomic_store()
+  std::shared_ptr<const Snapshot> current;
+  std::atomic<uint64_t> version{0};
+
+  // serializes the updates, readers never take it
+  std::mutex mutex;
+  std::condition_variable revision_cv;
+  std::atomic<size_t> resync_count{0};
+
+  // shared with the wait callbacks of watchers, which may run after the
+  // watcher (and the cache) has gone
+  struct Signal;
+  std::shared_ptr<Signal> signal;
+
+  // only touched by the worker, once it is started
+  std::unique_ptr<Watcher> watcher;
+  std::thread worker;
+};
+
+}  // namespace etcd
+
+#endif
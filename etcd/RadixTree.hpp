@@ -0,0 +1,191 @@
+#ifndef __ETCD_RADIX_TREE_HPP__
+#define __ETCD_RADIX_TREE_HPP__
+
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "etcd/Value.hpp"
+
+namespace etcd {
+
+/**
+ * An ordered index of values by key, as a radix tree: the keys are split into
+ * edge labels, and a common prefix (e.g., `/services/foo/instances/`) is only
+ * stored once.
+ *
+ * The nodes live in a single array and refer to each other by position, and
+ * the labels live in a single buffer, thus a lookup of a key of length k
+ * touches O(k) nodes in contiguous memory rather than O(log n) heap-allocated
+ * map nodes, and copying a tree copies a few flat arrays. The values are
+ * kept the same way, their bytes in a single buffer and the revisions in an
+ * array, without the keys, which are the paths to their nodes: a key is only
+ * stored (in the labels) once, and an insert doesn't allocate unless the
+ * buffers grow. A `Value` (with its key) is rebuilt when read.
+ *
+ * The children of a node are ordered by the first byte of their labels, and
+ * a pre-order traversal visits the keys in the same (byte-wise) order as
+ * etcd.
+ */
+class RadixTree {
+ public:
+  /**
+   * Iterates the values in key order.
+   */
+  class const_iterator {
+   public:
+    const_iterator() : tree(nullptr), node(NIL) {}
+
+    // the value is rebuilt on first access, and is valid until the iterator
+    // moves
+    Value const& operator*() const { return this->load(); }
+    Value const* operator->() const { return &this->load(); }
+    const_iterator& operator++() {
+      node = tree->next(node);
+      return *this;
+    }
+    bool operator==(const_iterator const& other) const {
+      return node == other.node;
+    }
+    bool operator!=(const_iterator const& other) const {
+      return node != other.node;
+    }
+
+   private:
+    friend class RadixTree;
+    const_iterator(RadixTree const* tree, uint32_t const node)
+        : tree(tree), node(node) {}
+
+    Value const& load() const {
+      if (loaded != node) {
+        tree->value_of(node, value);
+        loaded = node;
+      }
+      return value;
+    }
+
+    RadixTree const* tree;
+    uint32_t node;
+    mutable uint32_t loaded = NIL;
+    mutable Value value = RadixTree::blank_value();
+  };
+
+  RadixTree();
+
+  /**
+   * Returns the number of keys in the tree.
+   */
+  size_t size() const { return this->entries; }
+
+  bool empty() const { return this->entries == 0; }
+
+  /**
+   * Looks up a key, returns false if the key does not exist.
+   */
+  bool find(std::string const& key, Value& value) const;
+
+  /**
+   * Reads the value of a key only, returns false if the key does not exist.
+   */
+  bool get(std::string const& key, std::string& value) const;
+
+  bool contains(std::string const& key) const;
+
+  /**
+   * Inserts the value under its key, or replaces the value of the key, returns
+   * true if the key is new.
+   */
+  bool insert(Value const& value);
+
+  /**
+   * Removes a key, returns false if the key does not exist.
+   */
+  bool erase(std::string const& key);
+
+  const_iterator begin() const {
+    return const_iterator(this, this->first_in(ROOT));
+  }
+  const_iterator end() const { return const_iterator(this, NIL); }
+
+  /**
+   * Returns the first value whose key is not less than the given key.
+   */
+  const_iterator lower_bound(std::string const& key) const;
+
+  /**
+   * Compares the key with the first key of the (non-empty) tree, as
+   * `std::string::compare()`, without rebuilding the first key.
+   */
+  int compare_first(std::string const& key) const;
+
+ private:
+  static const uint32_t NIL = std::numeric_limits<uint32_t>::max();
+  static const uint32_t ROOT = 0;
+
+  struct Node {
+    uint32_t label_offset = 0;
+    uint32_t label_length = 0;
+    uint32_t parent = NIL;
+    uint32_t first_child = NIL;
+    uint32_t next_sibling = NIL;
+    uint32_t value = NIL;
+  };
+
+  // a value without its key
+  struct Payload {
+    size_t offset;
+    uint32_t length;
+    int ttl;
+    int64_t created;
+    int64_t modified;
+    int64_t version;
+    int64_t lease;
+  };
+
+  // rebuilds the value of a node, and its key from the path
+  void value_of(uint32_t const node, Value& value) const;
+
+  // the storage of a rebuilt value
+  static Value blank_value() { return Value(); }
+
+  unsigned char first_byte(uint32_t const node) const {
+    return static_cast<unsigned char>(labels[nodes[node].label_offset]);
+  }
+
+  // the node of the key, NIL if the key is not in the tree
+  uint32_t locate(std::string const& key) const;
+
+  // the first node with a value in the subtree, in pre-order
+  uint32_t first_in(uint32_t node) const;
+
+  // the first node with a value after the subtree, in pre-order
+  uint32_t after(uint32_t node) const;
+
+  // the first node with a value after the node, in pre-order
+  uint32_t next(uint32_t const node) const;
+
+  uint32_t allocate_node();
+  uint32_t allocate_value(Value const& value);
+  // stores the bytes and the revisions of the value in the payload
+  void assign_value(Payload& payload, Value const& value);
+  void link_child(uint32_t const parent, uint32_t const child);
+  void unlink_child(uint32_t const parent, uint32_t const child);
+
+  // rebuilds the tree once the labels and the value bytes are mostly garbage
+  void maybe_compact();
+
+  std::vector<Node> nodes;
+  std::string labels;
+  std::vector<Payload> values;
+  std::string value_bytes;
+  std::vector<uint32_t> free_nodes;
+  std::vector<uint32_t> free_values;
+  size_t entries = 0;
+  // the bytes of labels and values that are no longer referenced
+  size_t garbage = 0;
+};
+
+}  // namespace etcd
+
+#endif
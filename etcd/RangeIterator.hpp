@@ -0,0 +1,226 @@
+#ifndef __ETCD_RANGE_ITERATOR_HPP__
+#define __ETCD_RANGE_ITERATOR_HPP__
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcdv3 {
+class AsyncRangeAction;
+}
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+
+/**
+ * Pages through a (possibly huge) range, `page_size` entries per request,
+ * rather than fetching the whole range in one response.
+ *
+ * All pages are read at the revision of the first page, i.e., the iteration
+ * sees a consistent snapshot of the range, and each page continues from the
+ * last key of the previous one. The next page is requested as soon as a page
+ * arrives, and thus is fetched while the caller processes the current one.
+ * At most two pages are held in memory.
+ *
+ * The pages are linearizable reads whatever the read consistency of the
+ * client, to not reach a member that lags behind the pinned revision.
+ *
+ * @code
+ *   etcd::RangeIterator iter(client, "/registry/", 1000);
+ *   while (iter.has_next()) {
+ *     etcd::Response page = iter.next();
+ *     if (!page.is_ok()) {
+ *       // e.g., the pinned revision has been compacted
+ *       break;
+ *     }
+ *     for (auto const& value : page.values()) {
+ *       ...
+ *     }
+ *   }
+ * @endcode
+ *
+ * An iterator is not thread-safe.
+ */
+class RangeIterator {
+ public:
+  /**
+   * Iterates the keys with the given prefix (all keys if empty), at the given
+   * revision if positive.
+   */
+  RangeIterator(Client const& client, std::string const& prefix,
+                size_t const page_size = 1000, bool const keys_only = false,
+                int64_t const revision = 0);
+  RangeIterator(SyncClient& client, std::string const& prefix,
+                size_t const page_size = 1000, bool const keys_only = false,
+                int64_t const revision = 0);
+
+  /**
+   * Iterates the keys in the range [key, range_end), at the given revision if
+   * positive.
+   */
+  RangeIterator(Client const& client, std::string const& key,
+                std::string const& range_end, size_t const page_size = 1000,
+                bool const keys_only = false, int64_t const revision = 0);
+  RangeIterator(SyncClient& client, std::string const& key,
+                std::string const& range_end, size_t const page_size = 1000,
+                bool const keys_only = false, int64_t const revision = 0);
+
+  RangeIterator(RangeIterator const&) = delete;
+  RangeIterator(RangeIterator&&) = delete;
+
+  /**
+   * Whether there may be more pages. The last page may be empty when the
+   * size of the range is a multiple of the page size.
+   */
+  bool has_next() const { return this->call != nullptr; }
+
+  /**
+   * Waits for the next page, and prefetches the one after it. The iteration
+   * stops at the first failed page, and an empty page is returned once the
+   * range is exhausted.
+   *
+   * Dropping the iterator cancels the prefetched request.
+   */
+  Response next();
+
+  /**
+   * Returns the revision the pages are read at, 0 before the first page if no
+   * revision is given.
+   */
+  int64_t revision() const { return this->pinned_revision; }
+
+  /**
+   * Returns the number of entries received so far.
+   */
+  size_t count() const { return this->received; }
+
+ private:
+  SyncClient& client;
+  std::string range_end;
+  size_t page_size;
+  bool keys_only;
+
+  int64_t pinned_revision = 0;
+  size_t received = 0;
+  // the request of the next page, in flight
+  std::shared_ptr<etcdv3::AsyncRangeAction> call;
+};
+
+/**
+ * Scans a range as several sub-ranges concurrently, rather than one page at a
+ * time, e.g., to load a large prefix at startup.
+ *
+ * The sub-ranges are either given by the caller (as the split keys), or
+ * chosen by the scan: it looks up the common prefix of the first and the last
+ * key of the range, and probes (with `count_only` requests) the number of
+ * keys under each value of the byte that follows the prefix, to cut the range
+ * into `partitions` sub-ranges of roughly the same number of keys.
+ *
+ * All sub-ranges are paged through (see also `RangeIterator`) at the same
+ * revision, with one request in flight per sub-range. As for the iterator,
+ * all reads are linearizable.
+ *
+ * @code
+ *   etcd::ParallelScan scan(client, "/registry/", 8);
+ *   etcd::Response resp = scan.scan([](etcd::Response const& page) {
+ *     for (auto const& value : page.values()) {
+ *       ...
+ *     }
+ *   });
+ * @endcode
+ */
+class ParallelScan {
+ public:
+  /**
+   * Receives the pages of the scan.
+   */
+  using Callback = std::function<void(Response const&)>;
+
+  /**
+   * Scans the keys with the given prefix (all keys if empty).
+   */
+  ParallelScan(Client const& client, std::string const& prefix,
+               size_t const partitions = 8, size_t const page_size = 1000,
+               bool const keys_only = false);
+  ParallelScan(SyncClient& client, std::string const& prefix,
+               size_t const partitions = 8, size_t const page_size = 1000,
+               bool const keys_only = false);
+
+  /**
+   * Scans the keys in the range [key, range_end).
+   */
+  ParallelScan(Client const& client, std::string const& key,
+               std::string const& range_end, size_t const partitions = 8,
+               size_t const page_size = 1000, bool const keys_only = false);
+  ParallelScan(SyncClient& client, std::string const& key,
+               std::string const& range_end, size_t const partitions = 8,
+               size_t const page_size = 1000, bool const keys_only = false);
+
+  /**
+   * Scans the keys in the range [key, range_end), split at the given keys.
+   */
+  ParallelScan(Client const& client, std::string const& key,
+               std::string const& range_end,
+               std::vector<std::string> const& splits,
+               size_t const page_size = 1000, bool const keys_only = false);
+  ParallelScan(SyncClient& client, std::string const& key,
+               std::string const& range_end,
+               std::vector<std::string> const& splits,
+               size_t const page_size = 1000, bool const keys_only = false);
+
+  ParallelScan(ParallelScan const&) = delete;
+  ParallelScan(ParallelScan&&) = delete;
+
+  /**
+   * Fetches the sub-ranges concurrently, and delivers the (non-empty) pages to
+   * the callback, on the calling thread.
+   *
+   * If `ordered`, the pages are delivered in key order, the pages of a
+   * sub-range are buffered until the previous sub-ranges have been delivered.
+   * Otherwise, the pages are delivered as they arrive.
+   *
+   * Returns the first failed response if any, the scan stops there.
+   */
+  Response scan(Callback const& callback, bool const ordered = true);
+
+  /**
+   * Returns the keys where the range has been split (after `scan()` if they
+   * are not given).
+   */
+  std::vector<std::string> const& splits() const { return this->split_keys; }
+
+  /**
+   * Returns the revision the range is read at, 0 before the scan.
+   */
+  int64_t revision() const { return this->pinned_revision; }
+
+  /**
+   * Returns the number of entries received so far.
+   */
+  size_t count() const { return this->received; }
+
+ private:
+  // chooses the split keys by probing the range, returns the failed probe if
+  // any.
+  Response split(std::string const& first_key);
+
+  SyncClient& client;
+  std::string key;
+  std::string range_end;
+  size_t partitions;
+  size_t page_size;
+  bool keys_only;
+
+  std::vector<std::string> split_keys;
+  int64_t pinned_revision = 0;
+  size_t received = 0;
+};
+
+}  // namespace etcd
+
+#endif
@@ -0,0 +1,174 @@
+#ifndef __ETCD_READ_THROUGH_CACHE_HPP__
+#define __ETCD_READ_THROUGH_CACHE_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+#include "etcd/Value.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+class Watcher;
+
+/**
+ * A read-through cache of single keys in front of `SyncClient::get()`, for
+ * point lookups of many sparse keys that are not worth mirroring a prefix
+ * (see also `PrefixCache`).
+ *
+ * A cached value is fresh for `ttl` after it has been read or revalidated.
+ * Once it expires, the cache still serves it immediately (stale while
+ * revalidate), and revalidates it in the background: a transaction compares
+ * the mod revision of the key with the cached one, and only reads the key if
+ * it has changed. A key that has been deleted is evicted.
+ *
+ * Optionally, the cache watches a prefix and evicts the keys that are put or
+ * deleted, which bounds the staleness to the latency of the watch rather
+ * than the ttl. The watch is not restarted once interrupted, the ttl still
+ * applies.
+ *
+ * The cache is bounded by the (approximate) bytes of the keys and values, the
+ * least recently used keys are evicted first.
+ */
+class ReadThroughCache {
+ public:
+  static const size_t DEFAULT_MAX_BYTES = 64 * 1024 * 1024;
+
+  ReadThroughCache(Client const& client, std::chrono::milliseconds const& ttl,
+                   size_t const max_bytes = DEFAULT_MAX_BYTES);
+  ReadThroughCache(SyncClient& client, std::chrono::milliseconds const& ttl,
+                   size_t const max_bytes = DEFAULT_MAX_BYTES);
+
+  /**
+   * Watches the given prefix (all keys if empty) to evict the changed keys.
+   */
+  ReadThroughCache(Client const& client, std::chrono::milliseconds const& ttl,
+                   size_t const max_bytes, std::string const& watch_prefix);
+  ReadThroughCache(SyncClient& client, std::chrono::milliseconds const& ttl,
+                   size_t const max_bytes, std::string const& watch_prefix);
+
+  ReadThroughCache(ReadThroughCache const&) = delete;
+  ReadThroughCache(ReadThroughCache&&) = delete;
+
+  /**
+   * Stops watching and revalidating, the pending revalidations are dropped.
+   */
+  ~ReadThroughCache();
+
+  /**
+   * Gets a key, the response is the same as `SyncClient::get()`. A cached
+   * value is returned as of the revision it was read (or revalidated) at,
+   * i.e., the index of the response.
+   */
+  Response get(std::string const& key);
+
+  /**
+   * Evicts a key, e.g., after writing it.
+   */
+  void invalidate(std::string const& key);
+
+  /**
+   * Evicts all keys.
+   */
+  void clear();
+
+  /**
+   * Returns the number of cached keys.
+   */
+  size_t size() const;
+
+  /**
+   * Returns the (approximate) bytes taken by the cached keys and values.
+   */
+  size_t bytes() const;
+
+  /**
+   * Returns the number of reads served with a fresh value.
+   */
+  size_t hits() const { return this->hit_count.load(); }
+
+  /**
+   * Returns the number of reads that went to the server.
+   */
+  size_t misses() const { return this->miss_count.load(); }
+
+  /**
+   * Returns the number of reads served with an expired value.
+   */
+  size_t stale_hits() const { return this->stale_count.load(); }
+
+  /**
+   * Returns the number of finished revalidations.
+   */
+  size_t revalidations() const { return this->revalidation_count.load(); }
+
+ private:
+  using clock_type = std::chrono::steady_clock;
+
+  // the estimated bookkeeping cost of a key, besides its bytes
+  static const size_t ENTRY_OVERHEAD = 128;
+
+  struct Entry {
+    Value value;
+    int64_t index;
+    clock_type::time_point expires;
+    bool revalidating;
+    size_t bytes;
+    std::list<std::string>::iterator position;
+  };
+
+  // caches a value, read at the revision `index`
+  void store(std::string const& key, Value const& value, int64_t const index);
+
+  // drops a key, with the lock held
+  void evict(std::unordered_map<std::string, Entry>::iterator iter);
+
+  // the cached response of an entry
+  Response respond(Entry const& entry) const;
+
+  // revalidates the expired keys
+  void run();
+  void revalidate(std::string const& key);
+
+  // evicts the keys of the watch events
+  void apply(Response const& resp);
+
+  SyncClient& client;
+  std::chrono::milliseconds ttl;
+  size_t max_bytes;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  std::unordered_map<std::string, Entry> entries;
+  // the least recently used key first
+  std::list<std::string> lru;
+  size_t used_bytes = 0;
+  // the revision of the latest watch event, a read behind it may have missed
+  // the eviction
+  int64_t watched_revision = 0;
+
+  std::deque<std::string> pending;
+  bool stopped = false;
+
+  std::atomic<size_t> hit_count{0};
+  std::atomic<size_t> miss_count{0};
+  std::atomic<size_t> stale_count{0};
+  std::atomic<size_t> revalidation_count{0};
+
+  std::unique_ptr<Watcher> watcher;
+  std::thread worker;
+};
+
+}  // namespace etcd
+
+#endif
@@ -31,9 +31,19 @@ inline const std::chrono::microseconds duration_till_now(
 }  // namespace detail
 
 // forward declaration
+class EventBus;
 class KeepAlive;
+class MultiKeyWatcher;
+class NegativeCache;
+class ParallelScan;
+class PrefixCache;
+class ReadThroughCache;
 class Watcher;
 
+namespace concurrency {
+class Recipe;
+}  // namespace concurrency
+
 /**
  * The Response object received for the requests of etcd::Client
  */
@@ -157,6 +167,13 @@ class Response {
    */
   std::string const& key(int index) const;
 
+  /**
+   * Returns the number of keys in the range of a `count()` (or an 'ls')
+   * operation, regardless of the limit, or the number of keys deleted by a
+   * 'rm' or 'rmdir' operation.
+   */
+  int64_t count() const;
+
   /**
    * Returns the compact_revision if the response is a watch-cancelled revision.
    * `-1` means uninitialized (the response is not watch-cancelled)
@@ -214,6 +231,12 @@ class Response {
    */
   std::vector<etcdv3::Member> const& members() const;
 
+  /**
+   * Returns the responses of the operations in a transaction, in the order of
+   * the operations.
+   */
+  std::vector<Response> const& responses() const;
+
  protected:
   Response(const etcdv3::V3Response& response,
            std::chrono::microseconds const& duration);
@@ -228,6 +251,7 @@ class Response {
   Value _prev_value;
   Values _values;
   Keys _keys;
+  int64_t _count = 0;              // for range and delete
   int64_t _compact_revision = -1;  // for watch
   int64_t _watch_id = -1;          // for watch
   std::string _lock_key;           // for lock
@@ -248,10 +272,20 @@ class Response {
   // for member list
   std::vector<etcdv3::Member> _members;
 
+  // for txn
+  std::vector<Response> _responses;
+
   friend class Client;
   friend class SyncClient;
+  friend class EventBus;
   friend class KeepAlive;
+  friend class MultiKeyWatcher;
+  friend class NegativeCache;
+  friend class ParallelScan;
+  friend class PrefixCache;
+  friend class ReadThroughCache;
   friend class Watcher;
+  friend class concurrency::Recipe;
 
   friend class etcdv3::AsyncWatchAction;
   friend class etcdv3::AsyncLeaseKeepAliveAction;
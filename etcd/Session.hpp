@@ -0,0 +1,108 @@
+#ifndef __ETCD_SESSION_HPP__
+#define __ETCD_SESSION_HPP__
+
+#include <atomic>
+#include <string>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+
+/**
+ * Serializable reads with read-your-writes consistency.
+ *
+ * A serializable read is served by the local state of whichever member
+ * receives it, and a member that lags behind the leader may return a value
+ * older than a write that this client has just made. A session remembers the
+ * highest revision of the writes made through it (or passed to `observe()`),
+ * and only accepts a serializable read whose header revision is not behind
+ * it. Otherwise the read is retried, which the round robin load balancing of
+ * the client sends to the next member, up to `max_retries` times, and then
+ * falls back to a linearizable read.
+ *
+ * @code
+ *   etcd::Session session(client);
+ *   session.set("/app/config", "v2");
+ *   // never returns a value older than "v2", unless changed by others
+ *   etcd::Response resp = session.get("/app/config");
+ * @endcode
+ *
+ * The reads of a session are monotonic as well: a read observes the
+ * revisions of the earlier reads.
+ *
+ * A session can be shared by threads.
+ */
+class Session {
+ public:
+  static const size_t DEFAULT_MAX_RETRIES = 2;
+
+  Session(Client const& client, size_t const max_retries = DEFAULT_MAX_RETRIES);
+  Session(SyncClient& client, size_t const max_retries = DEFAULT_MAX_RETRIES);
+
+  /**
+   * Returns the revision that the reads of the session must reflect.
+   */
+  int64_t revision() const { return this->session_revision.load(); }
+
+  /**
+   * Records the revision of a response, e.g., of a write that is not made
+   * through the session.
+   */
+  void observe(Response const& resp);
+
+  /**
+   * The writes, the same as the ones of `SyncClient`.
+   */
+  Response set(std::string const& key, std::string const& value,
+               const int64_t leaseId = 0);
+  Response add(std::string const& key, std::string const& value,
+               const int64_t leaseId = 0);
+  Response put(std::string const& key, std::string const& value,
+               const int64_t leaseId = 0);
+  Response modify(std::string const& key, std::string const& value,
+                  const int64_t leaseId = 0);
+  Response rm(std::string const& key);
+  Response rmdir(std::string const& key, bool recursive = false);
+  Response rmdir(std::string const& key, std::string const& range_end);
+  Response txn(etcdv3::Transaction const& txn);
+
+  /**
+   * The serializable reads, the same as the ones of `SyncClient`.
+   */
+  Response get(std::string const& key);
+  Response ls(std::string const& prefix);
+  Response ls(std::string const& key, std::string const& range_end);
+
+  /**
+   * Returns the number of serializable reads that were retried as they were
+   * behind the session.
+   */
+  size_t retries() const { return this->retry_count.load(); }
+
+  /**
+   * Returns the number of reads that fell back to linearizable.
+   */
+  size_t fallbacks() const { return this->fallback_count.load(); }
+
+ private:
+  // records the revision of a write, and passes the response through
+  Response written(Response const& resp);
+
+  // a serializable range read that is not behind the session
+  Response read(std::string const& key, std::string const& range_end,
+                bool const with_prefix);
+
+  SyncClient& client;
+  size_t max_retries;
+  std::atomic<int64_t> session_revision{0};
+
+  std::atomic<size_t> retry_count{0};
+  std::atomic<size_t> fallback_count{0};
+};
+
+}  // namespace etcd
+
+#endif
@@ -0,0 +1,103 @@
+#ifndef __ETCD_SNAPSHOT_HPP__
+#define __ETCD_SNAPSHOT_HPP__
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "etcd/Response.hpp"
+#include "etcd/SyncClient.hpp"
+
+namespace etcdv3 {
+class AsyncRangeAction;
+}
+
+namespace etcd {
+// forward declaration to avoid header/library dependency
+class Client;
+
+/**
+ * A group of reads pinned to a single revision, e.g., for a handful of
+ * related keys that must not be observed across revisions (a torn state).
+ *
+ * The revision is pinned by the first read, i.e., the revision the server
+ * has answered it at, or by a `head()` if a batch of keys is read first. All
+ * following reads are issued at that revision, and the keys of a batch are
+ * requested in parallel, thus the reads are consistent with each other
+ * without a transaction.
+ *
+ * @code
+ *   etcd::Snapshot snapshot(client);
+ *   etcd::Response config = snapshot.get("/app/config");
+ *   std::vector<etcd::Response> shards =
+ *       snapshot.get({"/app/shards/0", "/app/shards/1", "/app/shards/2"});
+ * @endcode
+ *
+ * The reads are linearizable whatever the read consistency of the client,
+ * as a serializable read may reach a member that hasn't applied the pinned
+ * revision yet.
+ *
+ * The reads fail once the pinned revision has been compacted. The index of
+ * the responses is the revision of the cluster when answering, use
+ * `revision()` for the revision the values are read at.
+ *
+ * A snapshot can be shared by threads.
+ */
+class Snapshot {
+ public:
+  /**
+   * Reads at the given revision if positive, otherwise the revision is
+   * pinned by the first read.
+   */
+  Snapshot(Client const& client, int64_t const revision = 0);
+  Snapshot(SyncClient& client, int64_t const revision = 0);
+
+  /**
+   * Returns the pinned revision, 0 if no read has succeeded yet.
+   */
+  int64_t revision() const { return this->pinned_revision.load(); }
+
+  /**
+   * Gets a key at the pinned revision, the response is the same as
+   * `SyncClient::get()`.
+   */
+  Response get(std::string const& key);
+
+  /**
+   * Gets the keys at the pinned revision, in parallel, the responses are in
+   * the order of the keys.
+   */
+  std::vector<Response> get(std::vector<std::string> const& keys);
+
+  /**
+   * Lists the keys with the given prefix at the pinned revision.
+   */
+  Response ls(std::string const& prefix);
+
+  /**
+   * Lists the keys in the range [key, range_end) at the pinned revision.
+   */
+  Response ls(std::string const& key, std::string const& range_end);
+
+ private:
+  // issues a read at the pinned revision, and pins the revision of the
+  // response if none has been pinned yet
+  Response read(std::function<std::shared_ptr<etcdv3::AsyncRangeAction>(
+                    int64_t)> const& call);
+
+  // pins the revision if none has been pinned yet, returns false if another
+  // read has pinned a different one
+  bool pin(int64_t const revision);
+
+  // pins the current revision of the cluster if none has been pinned yet
+  Response pin_head();
+
+  SyncClient& client;
+  std::atomic<int64_t> pinned_revision;
+};
+
+}  // namespace etcd
+
+#endif
@@ -1,12 +1,15 @@
 #ifndef __ETCD_SYNC_CLIENT_HPP__
 #define __ETCD_SYNC_CLIENT_HPP__
 
+#include <atomic>
 #include <chrono>
+#include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <ratio>
 #include <string>
+#include <vector>
 
 #include "etcd/Response.hpp"
 #include "etcd/v3/action_constants.hpp"
@@ -67,10 +70,63 @@ using etcdv3::ERROR_COMPARE_FAILED;
 using etcdv3::ERROR_KEY_ALREADY_EXISTS;
 using etcdv3::ERROR_KEY_NOT_FOUND;
 
+class BatchReader;
+class BatchWriter;
 class KeepAlive;
+class ParallelScan;
+class RangeIterator;
+class Session;
+class Snapshot;
 class Watcher;
 class Client;
 
+namespace concurrency {
+class Recipe;
+}  // namespace concurrency
+
+/**
+ * The consistency of range reads (`get()`, `ls()`, `keys()` and `count()`).
+ */
+enum class ReadConsistency {
+  // goes through the read index of the leader, reflects all writes that have
+  // been committed before the read starts
+  LINEARIZABLE,
+  // served by the local state of the member that receives the request,
+  // without reaching the leader, may be stale
+  SERIALIZABLE,
+};
+
+/**
+ * Options of range reads (`get()`, `ls()` and `keys()`), the sorting and
+ * filtering happen on the etcd server, see also `RangeRequest`.
+ */
+struct RangeOptions {
+  enum class SortOrder { NONE = 0, ASCEND = 1, DESCEND = 2 };
+  enum class SortTarget {
+    KEY = 0,
+    VERSION = 1,
+    CREATE = 2,
+    MOD = 3,
+    VALUE = 4,
+  };
+
+  // the size limit of results, 0 means no limit
+  size_t limit = 0;
+  // the revision to read at, 0 means the latest one
+  int64_t revision = 0;
+
+  SortOrder sort_order = SortOrder::NONE;
+  SortTarget sort_target = SortTarget::KEY;
+
+  // bounds (inclusive) of the revision of the last modification and of the
+  // creation of the returned keys, 0 means unbounded, e.g., the keys changed
+  // since revision R are the ones with `min_mod_revision = R + 1`.
+  int64_t min_mod_revision = 0;
+  int64_t max_mod_revision = 0;
+  int64_t min_create_revision = 0;
+  int64_t max_create_revision = 0;
+};
+
 /**
  * Client is responsible for maintaining a connection towards an etcd server.
  * Etcd operations can be reached via the methods of the client.
@@ -93,7 +149,20 @@ class SyncClient {
     void operator()(TokenAuthenticator* authenticator);
   };
 
+  // asynchronous election calls, driven by a shared event loop
+  struct ElectionCall;
+  struct ElectionEventLoop;
+  struct ElectionEventLoopDeleter {
+    void operator()(ElectionEventLoop* loop);
+  };
+
  public:
+  /**
+   * Executor to run the callbacks of asynchronous calls, the callbacks run
+   * inline on the event loop thread of the client if no executor is given.
+   */
+  using Executor = std::function<void(std::function<void()>)>;
+
   /**
    * Constructs an etcd client object.
    *
@@ -330,6 +399,40 @@ class SyncClient {
    */
   Response get(std::string const& key, int64_t revision);
 
+  /**
+   * Get the value of specified key from the etcd server, with the given
+   * consistency rather than the one of the client.
+   * @param key is the key to be read
+   * @param consistency is the consistency of the read
+   */
+  Response get(std::string const& key, ReadConsistency consistency);
+
+  /**
+   * Get the value of specified key from the etcd server, if it matches the
+   * revision filters of the options.
+   * @param key is the key to be read
+   * @param options are the revision and filters of the read
+   */
+  Response get(std::string const& key, RangeOptions const& options);
+
+  /**
+   * Get the values of many keys, packing the reads into transactions of at
+   * most `max_ops` operations (see `--max-txn-ops` of the etcd server), rather
+   * than one round trip per key. The reads in one transaction see the same
+   * revision.
+   *
+   * @param keys are the keys to be read
+   * @param max_ops is the maximum number of operations in a transaction
+   * @param max_inflight is the maximum number of transactions on the wire at
+   * the same time
+   *
+   * @returns the responses, in the same order of `keys`, as if each key is
+   * read by `get()`.
+   */
+  std::vector<Response> get_many(std::vector<std::string> const& keys,
+                                 size_t const max_ops = 128,
+                                 size_t const max_inflight = 16);
+
   /**
    * Sets the value of a key. The key will be modified if already exists or
    * created if it does not exists.
@@ -459,6 +562,42 @@ class SyncClient {
    */
   Response rmdir(std::string const& key, std::string const& range_end);
 
+  /**
+   * Receives the number of keys deleted so far by a chunked delete.
+   */
+  using DeleteProgress = std::function<void(int64_t)>;
+
+  /**
+   * Removes the keys prefixed by the key in chunks of at most `chunk_size`
+   * keys: lists a page of keys (keys only), then deletes the sub-range of the
+   * page, until no key is left. Each chunk is a bounded raft entry and
+   * response, rather than one delete of the whole directory.
+   *
+   * Note that the directory is not removed atomically, and a key that is put
+   * in the range while the delete is in progress may or may not be removed.
+   *
+   * @param key is the prefix of the keys to be removed
+   * @param chunk_size is the maximum number of keys removed per request
+   * @param prev_kv whether to return the removed key-values (in `values()`)
+   * @param progress receives the number of keys deleted after each chunk
+   *
+   * @return The total number of deleted keys is `count()` of the response
+   * (also of a failed response). Returns etcdv3::ERROR_KEY_NOT_FOUND if no
+   * key has been deleted.
+   */
+  Response rmdir_chunked(std::string const& key, size_t const chunk_size = 1000,
+                         bool const prev_kv = false,
+                         DeleteProgress const& progress = nullptr);
+
+  /**
+   * Removes the keys between [key, range_end) in chunks of at most
+   * `chunk_size` keys, see also `rmdir_chunked()` above.
+   */
+  Response rmdir_chunked(std::string const& key, std::string const& range_end,
+                         size_t const chunk_size = 1000,
+                         bool const prev_kv = false,
+                         DeleteProgress const& progress = nullptr);
+
   /**
    * Gets a directory listing of the directory prefixed by the key.
    *
@@ -472,7 +611,7 @@ class SyncClient {
    * @param key is the key to be listed
    * @param limit is the size limit of results to be listed, we don't use
    * default parameters to ensure backwards binary compatibility. 0 means no
-   * limit.
+   * limit. See also `RangeIterator` to page through a large directory.
    */
   Response ls(std::string const& key, size_t const limit);
 
@@ -526,6 +665,46 @@ class SyncClient {
   Response ls(std::string const& key, std::string const& range_end,
               size_t const limit, int64_t revision);
 
+  /**
+   * Gets a directory listing of the directory prefixed by the key, sorted and
+   * filtered by the etcd server as the options specify.
+   *
+   * @param key is the key to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  Response ls(std::string const& key, RangeOptions const& options);
+
+  /**
+   * Gets a directory listing of the range [key, range_end), sorted and
+   * filtered by the etcd server as the options specify.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  Response ls(std::string const& key, std::string const& range_end,
+              RangeOptions const& options);
+
+  /**
+   * Gets a directory listing of the directory prefixed by the key, with the
+   * given consistency rather than the one of the client.
+   *
+   * @param key is the key to be listed
+   * @param consistency is the consistency of the read
+   */
+  Response ls(std::string const& key, ReadConsistency consistency);
+
+  /**
+   * Gets a directory listing of the range [key, range_end), with the given
+   * consistency rather than the one of the client.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param consistency is the consistency of the read
+   */
+  Response ls(std::string const& key, std::string const& range_end,
+              ReadConsistency consistency);
+
   /**
    * Gets a directory listing of the directory prefixed by the key.
    *
@@ -599,6 +778,91 @@ class SyncClient {
   Response keys(std::string const& key, std::string const& range_end,
                 size_t const limit, int64_t revision);
 
+  /**
+   * List keys prefixed by the key, sorted and filtered by the etcd server as
+   * the options specify.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  Response keys(std::string const& key, RangeOptions const& options);
+
+  /**
+   * List keys in the range [key, range_end), sorted and filtered by the etcd
+   * server as the options specify.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param options are the limit, revision, sorting and filters of the listing
+   */
+  Response keys(std::string const& key, std::string const& range_end,
+                RangeOptions const& options);
+
+  /**
+   * List keys prefixed by the key, with the given consistency rather than the
+   * one of the client.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param consistency is the consistency of the read
+   */
+  Response keys(std::string const& key, ReadConsistency consistency);
+
+  /**
+   * List keys in the range [key, range_end), with the given consistency
+   * rather than the one of the client.
+   *
+   * Note that only keys are included in the response.
+   *
+   * @param key is the key to be listed
+   * @param range_end is the end of key range to be listed
+   * @param consistency is the consistency of the read
+   */
+  Response keys(std::string const& key, std::string const& range_end,
+                ReadConsistency consistency);
+
+  /**
+   * Counts the keys prefixed by the key, without transferring any of them.
+   * The number is available as `count()` of the response.
+   *
+   * @param key is the prefix of the keys to be counted
+   */
+  Response count(std::string const& key);
+
+  /**
+   * Counts the keys in the range [key, range_end), without transferring any
+   * of them. The number is available as `count()` of the response.
+   *
+   * @param key is the key to be counted
+   * @param range_end is the end of key range to be counted
+   */
+  Response count(std::string const& key, std::string const& range_end);
+
+  /**
+   * Counts the keys prefixed by the key, with the given consistency rather
+   * than the one of the client.
+   *
+   * @param key is the prefix of the keys to be counted
+   * @param consistency is the consistency of the read
+   */
+  Response count(std::string const& key, ReadConsistency consistency);
+
+  /**
+   * Counts the keys in the range [key, range_end), with the given consistency
+   * rather than the one of the client.
+   *
+   * @param key is the key to be counted
+   * @param range_end is the end of key range to be counted
+   * @param consistency is the consistency of the read
+   */
+  Response count(std::string const& key, std::string const& range_end,
+                 ReadConsistency consistency);
+
   /**
    * Watches for changes of a key or a subtree. Please note that if you watch
    * e.g. "/testdir" and a new key is created, like "/testdir/newkey" then no
@@ -682,6 +946,39 @@ class SyncClient {
    */
   Response leases();
 
+  /**
+   * Grants many leases, with at most `max_inflight` requests on the wire at
+   * the same time.
+   *
+   * @param ttls are the time to live of the leases
+   * @param max_inflight is the size of the pipelining window
+   *
+   * @returns the responses, in the same order of `ttls`
+   */
+  std::vector<Response> leasegrant_batch(std::vector<int> const& ttls,
+                                         size_t const max_inflight = 64);
+
+  /**
+   * Revokes many leases, see also `leasegrant_batch()`.
+   */
+  std::vector<Response> leaserevoke_batch(std::vector<int64_t> const& lease_ids,
+                                          size_t const max_inflight = 64);
+
+  /**
+   * Gets the time-to-live of many leases, see also `leasegrant_batch()`.
+   */
+  std::vector<Response> leasetimetolive_batch(
+      std::vector<int64_t> const& lease_ids, size_t const max_inflight = 64);
+
+  /**
+   * Lists all alive leases with their time-to-live, i.e., `leases()` followed
+   * by `leasetimetolive_batch()`.
+   *
+   * @returns the time-to-live responses of the leases, or a single error
+   * response if listing the leases failed.
+   */
+  std::vector<Response> leases_with_ttl(size_t const max_inflight = 64);
+
   /**
    * Add an etcd member to the etcd cluster, equivalent to `etcdctl member add`.
    * @param peer_urls is comma separated list of URLs for the new member.
@@ -753,6 +1050,53 @@ class SyncClient {
   Response campaign(std::string const& name, int64_t lease_id,
                     std::string const& value);
 
+  /**
+   * A pending asynchronous campaign, which will be cancelled when being
+   * destructed.
+   */
+  class Campaigner {
+   public:
+    ~Campaigner();
+
+    /**
+     * Cancels the campaign if it is still pending, and waits until the
+     * callback has been issued (unless called inside the callback).
+     *
+     * The campaign may have been won before the cancellation, the callback
+     * tells which one happens.
+     */
+    void Cancel();
+
+    /**
+     * Whether the campaign has been finished (won, failed or cancelled).
+     */
+    bool Done() const;
+
+   private:
+    std::shared_ptr<ElectionCall> call = nullptr;
+
+    friend class SyncClient;
+  };
+
+  /**
+   * Campaign for the election @name@ asynchronously, without blocking a thread
+   * while waiting for the leadership.
+   *
+   * @param name is the name of election that will campaign for.
+   * @param lease_id is a user-managed (usually with a `KeepAlive`) lease id.
+   * @param value is the value for campaign.
+   * @param callback will be invoked once with the campaign response, see
+   *        `campaign()` above, or with an error if failed or cancelled.
+   * @param executor runs the callback, see `Executor`.
+   *
+   * @returns a campaigner that can be used to cancel the campaign.
+   */
+  std::unique_ptr<Campaigner> campaign(std::string const& name,
+                                       int64_t lease_id,
+                                       std::string const& value,
+                                       std::function<void(Response)> callback,
+                                       Executor const& executor = nullptr);
+
   /**
    * Updates the value of election with a new value, with leader key returns by
    * @campaign@.
@@ -783,11 +1127,17 @@ class SyncClient {
   class Observer {
    public:
     ~Observer();
-    // wait at least *one* response from the observer.
+    // wait at least *one* response from the observer, not available for
+    // observers with a callback.
     Response WaitOnce();
 
+    // stop observing, the callback won't be invoked after it returns (unless
+    // called inside the callback).
+    void Cancel();
+
    private:
     std::shared_ptr<etcdv3::AsyncObserveAction> action = nullptr;
+    std::shared_ptr<ElectionCall> call = nullptr;
 
     friend class SyncClient;
   };
@@ -802,6 +1152,23 @@ class SyncClient {
    */
   std::unique_ptr<Observer> observe(std::string const& name);
 
+  /**
+   * Observe the leader change with a callback.
+   *
+   * The observing streams of a client share one completion queue and one
+   * event loop thread, rather than a thread per election.
+   *
+   * @param name is the names of election to watch.
+   * @param callback will be invoked with every leader change in order, and
+   *        with an error response once if the stream is broken.
+   * @param executor runs the callback, see `Executor`.
+   *
+   * @returns an observer that will cancel the observing when being destructed.
+   */
+  std::unique_ptr<Observer> observe(std::string const& name,
+                                    std::function<void(Response)> callback,
+                                    Executor const& executor = nullptr);
+
   /**
    * Updates the value of election with a new value, with leader key returns by
    * @campaign@.
@@ -819,6 +1186,9 @@ class SyncClient {
   std::shared_ptr<etcdv3::AsyncHeadAction> head_internal();
   std::shared_ptr<etcdv3::AsyncRangeAction> get_internal(
       std::string const& key, const int64_t revision = 0);
+  std::shared_ptr<etcdv3::AsyncRangeAction> get_internal(
+      std::string const& key, const int64_t revision,
+      ReadConsistency consistency);
   std::shared_ptr<etcdv3::AsyncSetAction> add_internal(
       std::string const& key, std::string const& value,
       const int64_t leaseId = 0);
@@ -840,17 +1210,44 @@ class SyncClient {
   std::shared_ptr<etcdv3::AsyncDeleteAction> rmdir_internal(
       std::string const& key, bool recursive = false);
   std::shared_ptr<etcdv3::AsyncDeleteAction> rmdir_internal(
-      std::string const& key, std::string const& range_end);
+      std::string const& key, std::string const& range_end,
+      bool const prev_kv = true);
   std::shared_ptr<etcdv3::AsyncRangeAction> ls_internal(
       std::string const& key, size_t const limit, bool const keys_only = false,
       int64_t revision = 0);
+  std::shared_ptr<etcdv3::AsyncRangeAction> ls_internal(
+      std::string const& key, size_t const limit, bool const keys_only,
+      int64_t revision, ReadConsistency consistency);
   std::shared_ptr<etcdv3::AsyncRangeAction> ls_internal(
       std::string const& key, std::string const& range_end, size_t const limit,
       bool const keys_only = false, int64_t revision = 0);
+  std::shared_ptr<etcdv3::AsyncRangeAction> ls_internal(
+      std::string const& key, std::string const& range_end, size_t const limit,
+      bool const keys_only, int64_t revision, ReadConsistency consistency);
+  // the first (or the last) created keys under the prefix, whose create
+  // revision is not larger than `max_create_revision` (if positive).
+  std::shared_ptr<etcdv3::AsyncRangeAction> ls_by_create_internal(
+      std::string const& prefix, bool const first, bool const keys_only,
+      int64_t max_create_revision = 0, size_t const limit = 1);
+  // a range request with the given parameters, e.g., probes with `count_only`
+  // or a sort order.
+  std::shared_ptr<etcdv3::AsyncRangeAction> range_internal(
+      etcdv3::ActionParameters& params);
+  std::shared_ptr<etcdv3::AsyncRangeAction> range_internal(
+      std::string const& key, std::string const& range_end,
+      bool const with_prefix, bool const keys_only,
+      RangeOptions const& options);
+  std::shared_ptr<etcdv3::AsyncRangeAction> count_internal(
+      std::string const& key, std::string const& range_end,
+      bool const with_prefix);
+  std::shared_ptr<etcdv3::AsyncRangeAction> count_internal(
+      std::string const& key, std::string const& range_end,
+      bool const with_prefix, ReadConsistency consistency);
   std::shared_ptr<etcdv3::AsyncWatchAction> watch_internal(
       std::string const& key, int64_t fromIndex, bool recursive = false);
   std::shared_ptr<etcdv3::AsyncWatchAction> watch_internal(
       std::string const& key, std::string const& range_end, int64_t fromIndex);
+  std::shared_ptr<etcdv3::AsyncLeaseGrantAction> leasegrant_internal(int ttl);
   std::shared_ptr<etcdv3::AsyncLeaseRevokeAction> leaserevoke_internal(
       int64_t lease_id);
   std::shared_ptr<etcdv3::AsyncLeaseTimeToLiveAction> leasetimetolive_internal(
@@ -912,6 +1309,52 @@ class SyncClient {
     return this->grpc_timeout;
   }
 
+  /**
+   * Set the consistency of the range reads of this client, linearizable by
+   * default.
+   *
+   * Serializable reads are served by whichever member the request is routed
+   * to, saving the round trip to the leader and spreading the load over the
+   * cluster, at the cost of possibly stale results.
+   */
+  void set_read_consistency(ReadConsistency consistency) {
+    this->read_consistency.store(consistency);
+  }
+
+  /**
+   * Get the consistency of the range reads of this client.
+   */
+  ReadConsistency get_read_consistency() const {
+    return this->read_consistency.load();
+  }
+
+  /**
+   * Enable (or disable) coalescing of identical concurrent reads: a `get()`,
+   * `ls()` or `keys()` that is identical (the same key, range end, limit,
+   * revision, keys-only flag and consistency) to an in-flight one waits for
+   * the in-flight RPC and shares its response, rather than issuing another
+   * RPC.
+   *
+   * Disabled by default, as the shared response may reflect the state shortly
+   * before the call if the in-flight RPC was issued earlier.
+   */
+  void set_read_coalescing(bool enabled) {
+    this->coalesce_reads.store(enabled);
+  }
+
+  /**
+   * Whether coalescing of identical concurrent reads is enabled.
+   */
+  bool read_coalescing() const { return this->coalesce_reads.load(); }
+
+  /**
+   * Returns the number of reads that were served by an identical in-flight
+   * read.
+   */
+  size_t read_coalescing_hits() const {
+    return this->coalesced_read_hits.load();
+  }
+
  private:
 #if defined(WITH_GRPC_CHANNEL_CLASS)
   std::shared_ptr<grpc::Channel> channel;
@@ -923,6 +1366,7 @@ class SyncClient {
       token_authenticator;
   mutable std::chrono::microseconds grpc_timeout =
       std::chrono::microseconds::zero();
+  std::atomic<ReadConsistency> read_consistency{ReadConsistency::LINEARIZABLE};
 
   struct EtcdServerStubs;
   struct EtcdServerStubsDeleter {
@@ -930,13 +1374,58 @@ class SyncClient {
   };
   std::unique_ptr<EtcdServerStubs, EtcdServerStubsDeleter> stubs;
 
+  // identical concurrent reads share one in-flight RPC
+  struct ReadFlight;
+  // identifies identical range requests
+  static std::string read_signature(char const* op, std::string const& key,
+                                    std::string const& range_end,
+                                    size_t const limit, int64_t const revision);
+  static std::string read_signature(char const* op, std::string const& key,
+                                    std::string const& range_end,
+                                    RangeOptions const& options);
+  // joins the in-flight read of the signature, or starts a new flight (then
+  // `leader` is true), which the caller issues and lands
+  std::shared_ptr<ReadFlight> board_read(std::string const& signature,
+                                         ReadConsistency consistency,
+                                         bool& leader);
+  // publishes the response of a flight to the reads that have joined it
+  void land_read(std::shared_ptr<ReadFlight> const& flight,
+                 Response const& response);
+  // invokes the callback with the response once the flight lands
+  static void on_landed(std::shared_ptr<ReadFlight> const& flight,
+                        std::function<void(Response const&)> const& callback);
+  Response coalesced_read(
+      std::string const& signature,
+      std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+          make_call);
+  Response coalesced_read(
+      std::string const& signature, ReadConsistency consistency,
+      std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+          make_call);
+  std::atomic_bool coalesce_reads{false};
+  std::atomic<size_t> coalesced_read_hits{0};
+  std::mutex mutex_for_read_flights;
+  std::map<std::string, std::shared_ptr<ReadFlight>> read_flights;
+
+  // lazily started, see also `election_event_loop()`
+  std::mutex mutex_for_election_loop;
+  std::unique_ptr<ElectionEventLoop, ElectionEventLoopDeleter> election_loop;
+  ElectionEventLoop* election_event_loop();
+
   std::mutex mutex_for_keepalives;
   std::map<std::string, int64_t> leases_for_locks;
   std::map<int64_t, std::shared_ptr<KeepAlive>> keep_alive_for_locks;
 
+  friend class BatchReader;
+  friend class BatchWriter;
   friend class KeepAlive;
+  friend class ParallelScan;
+  friend class RangeIterator;
+  friend class Session;
+  friend class Snapshot;
   friend class Watcher;
   friend class Client;
+  friend class concurrency::Recipe;
 };
 
 }  // namespace etcd
@@ -77,6 +77,8 @@ class Value {
   friend class AsyncDeleteResponse;
 
   friend class Event;
+  friend class PrefixCache;
+  friend class RadixTree;
 
   Value();
   Value(etcdv3::KeyValue const& kvs);
@@ -200,8 +200,24 @@ class Watcher {
   std::unique_ptr<EtcdServerStubs, EtcdServerStubsDeleter> stubs;
 
  private:
+  friend class EventBus;
+  friend class PrefixCache;
+
+  // also delivers progress notifications to the callback, i.e., responses
+  // without events whose index is the revision the watch has reached, the
+  // server sends them periodically, and on `RequestProgress()`
+  Watcher(SyncClient const& client, std::string const& key, int64_t fromIndex,
+          std::function<void(Response)> callback,
+          std::function<void(bool)> wait_callback, bool recursive,
+          bool progress_notify);
+
+  // asks the server for a progress notification once the watch has caught
+  // up, not supported by etcd servers before v3.4
+  void RequestProgress();
+
   int64_t fromIndex;
   bool recursive;
+  bool progress_notify = false;
   std::atomic_bool cancelled;
 };
 }  // namespace etcd
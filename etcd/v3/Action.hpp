@@ -42,6 +42,15 @@ struct ActionParameters {
   std::string range_end;
   bool keys_only;
   bool count_only;
+  bool serializable;
+  bool prev_kv;          // for delete
+  bool progress_notify;  // for watch
+  etcdserverpb::RangeRequest::SortOrder sort_order;
+  etcdserverpb::RangeRequest::SortTarget sort_target;
+  int64_t min_mod_revision;
+  int64_t max_mod_revision;
+  int64_t min_create_revision;
+  int64_t max_create_revision;
   std::string value;
   std::string old_value;
   std::string auth_token;
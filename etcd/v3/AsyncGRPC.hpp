@@ -479,12 +479,28 @@ class AsyncWatchAction : public etcdv3::Action {
   void waitForResponse(std::function<void(etcd::Response)> callback);
   void CancelWatch();
   bool Cancelled() const;
+  // asks for a progress notification, see also `progress_notify`
+  void RequestProgress();
 
  private:
+  // with the write mutex held
+  void WriteProgressRequest();
+  void WriteCancelRequest();
+  // issues the write that waits for the progress request
+  void OnProgressWritten();
+
   int64_t watch_id = -1;
   WatchResponse reply;
   std::unique_ptr<ClientAsyncReaderWriter<WatchRequest, WatchResponse>> stream;
   std::atomic_bool isCancelled;
+
+  // a single write can be in flight on the stream
+  std::mutex write_mutex;
+  bool writing = false;
+  bool progress_pending = false;
+  bool cancel_pending = false;
+  // the stream is finished, nothing can be written any more
+  bool closed = false;
 };
 }  // namespace etcdv3
 
@@ -38,6 +38,8 @@ class V3Response {
   uint64_t get_raft_term() const;
   std::vector<int64_t> const& get_leases() const;
   std::vector<etcdv3::Member> const& get_members() const;
+  std::vector<V3Response> const& get_responses() const;
+  int64_t get_count() const;
 
  protected:
   int error_code;
@@ -63,6 +65,11 @@ class V3Response {
   std::vector<int64_t> leases;
   // for member list
   std::vector<etcdv3::Member> members;
+  // for txn: the response of each operation, in order
+  std::vector<V3Response> responses;
+  // for range: the number of keys in the range, for delete: the number of
+  // deleted keys
+  int64_t count = 0;
 };
 }  // namespace etcdv3
 #endif
@@ -44,6 +44,7 @@ extern char const* KEEPALIVE_FINISH;
 extern char const* WATCH_CREATE;
 extern char const* WATCH_WRITE;
 extern char const* WATCH_WRITE_CANCEL;
+extern char const* WATCH_WRITE_PROGRESS;
 extern char const* WATCH_WRITES_DONE;
 extern char const* WATCH_FINISH;
 
@@ -0,0 +1,107 @@
+#include <algorithm>
+#include <chrono>
+
+#include "etcd/Batch.hpp"
+#include "etcd/v3/AsyncGRPC.hpp"
+
+double etcd::BatchStats::throughput() const {
+  if (elapsed.count() == 0) {
+    return 0;
+  }
+  return completed * 1000000.0 / elapsed.count();
+}
+
+etcd::BatchPipeline::BatchPipeline(SyncClient& client,
+                                   size_t const max_inflight,
+                                   Callback const& callback)
+    : client(client),
+      window(std::max(max_inflight, static_cast<size_t>(1))),
+      callback(callback) {}
+
+etcd::BatchPipeline::~BatchPipeline() {
+  while (!pending.empty()) {
+    complete_one();
+  }
+}
+
+std::vector<etcd::Response> etcd::BatchPipeline::flush() {
+  while (!pending.empty()) {
+    complete_one();
+  }
+  std::vector<Response> collected;
+  collected.swap(results);
+  return collected;
+}
+
+void etcd::BatchPipeline::prepare(std::string const& key, bool const ordered) {
+  if (statistics.submitted == 0) {
+    start_timepoint = std::chrono::steady_clock::now();
+  }
+  while (pending.size() >= window) {
+    complete_one();
+  }
+  if (ordered) {
+    // requests on different calls may be reordered on the wire
+    while (pending_keys.find(key) != pending_keys.end()) {
+      complete_one();
+    }
+  }
+}
+
+size_t etcd::BatchPipeline::submit(std::string const& key,
+                                   std::function<Response()> const& wait) {
+  pending.emplace_back(Pending{key, wait});
+  pending_keys[key] += 1;
+  return statistics.submitted++;
+}
+
+void etcd::BatchPipeline::complete_one() {
+  Pending item = std::move(pending.front());
+  pending.pop_front();
+  auto iter = pending_keys.find(item.key);
+  if (--iter->second == 0) {
+    pending_keys.erase(iter);
+  }
+
+  Response resp = item.wait();
+  size_t index = statistics.completed;
+  statistics.completed += 1;
+  if (!resp.is_ok()) {
+    statistics.failed += 1;
+  }
+  statistics.elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start_timepoint);
+
+  if (callback) {
+    callback(index, resp);
+  } else {
+    results.emplace_back(resp);
+  }
+}
+
+etcd::BatchWriter::BatchWriter(SyncClient& client, size_t const max_inflight,
+                               Callback const& callback)
+    : BatchPipeline(client, max_inflight, callback) {}
+
+size_t etcd::BatchWriter::put(std::string const& key, std::string const& value,
+                              const int64_t leaseId) {
+  prepare(key, true);
+  auto call = client.put_internal(key, value, leaseId);
+  return submit(key, [call]() { return Response::create(call); });
+}
+
+size_t etcd::BatchWriter::rm(std::string const& key) {
+  prepare(key, true);
+  auto call = client.rm_internal(key);
+  return submit(key, [call]() { return Response::create(call); });
+}
+
+etcd::BatchReader::BatchReader(SyncClient& client, size_t const max_inflight,
+                               Callback const& callback)
+    : BatchPipeline(client, max_inflight, callback) {}
+
+size_t etcd::BatchReader::get(std::string const& key, int64_t revision) {
+  prepare(key, false);
+  auto call = client.get_internal(key, revision);
+  return submit(key, [call]() { return Response::create(call); });
+}
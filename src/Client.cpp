@@ -35,8 +35,20 @@
 #include "proto/v3election.grpc.pb.h"
 #include "proto/v3lock.grpc.pb.h"
 
+#include "etcd/Batch.hpp"
 #include "etcd/Client.hpp"
+#include "etcd/CoalescingWriter.hpp"
+#include "etcd/Concurrency.hpp"
+#include "etcd/EventBus.hpp"
 #include "etcd/KeepAlive.hpp"
+#include "etcd/LeaseBuckets.hpp"
+#include "etcd/MultiKeyWatcher.hpp"
+#include "etcd/NegativeCache.hpp"
+#include "etcd/PrefixCache.hpp"
+#include "etcd/RangeIterator.hpp"
+#include "etcd/ReadThroughCache.hpp"
+#include "etcd/Session.hpp"
+#include "etcd/Snapshot.hpp"
 #include "etcd/Watcher.hpp"
 #include "etcd/v3/Action.hpp"
 #include "etcd/v3/AsyncGRPC.hpp"
@@ -208,6 +220,43 @@ using responser_t = etcd::Response (*)(std::shared_ptr<T>);
 
 }  // namespace etcd
 
+pplx::task<etcd::Response> etcd::Client::coalesced_read(
+    std::string const& signature,
+    std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+        make_call) {
+  return this->coalesced_read(signature, this->client->get_read_consistency(),
+                              make_call);
+}
+
+pplx::task<etcd::Response> etcd::Client::coalesced_read(
+    std::string const& signature, ReadConsistency consistency,
+    std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+        make_call) {
+  if (!this->client->read_coalescing()) {
+    return etcd::detail::asyncify(
+        static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
+        make_call());
+  }
+
+  bool leader = false;
+  auto flight = this->client->board_read(signature, consistency, leader);
+  if (!leader) {
+    // completes with the in-flight read, without holding a thread
+    pplx::task_completion_event<etcd::Response> event;
+    SyncClient::on_landed(
+        flight, [event](Response const& resp) { event.set(resp); });
+    return pplx::task<etcd::Response>(event);
+  }
+
+  SyncClient* client = this->client;
+  std::shared_ptr<etcdv3::AsyncRangeAction> call = make_call();
+  return pplx::task<etcd::Response>([client, flight, call]() {
+    Response response = Response::create(call);
+    client->land_read(flight, response);
+    return response;
+  });
+}
+
 pplx::task<etcd::Response> etcd::Client::head() {
   return etcd::detail::asyncify(
       static_cast<etcd::responser_t<etcdv3::AsyncHeadAction>>(Response::create),
@@ -215,18 +264,32 @@ pplx::task<etcd::Response> etcd::Client::head() {
 }
 
 pplx::task<etcd::Response> etcd::Client::get(std::string const& key) {
-  return etcd::detail::asyncify(
-      static_cast<etcd::responser_t<etcdv3::AsyncRangeAction>>(
-          Response::create),
-      this->client->get_internal(key));
+  return this->coalesced_read(
+      SyncClient::read_signature("get", key, "", 0, 0),
+      [&]() { return this->client->get_internal(key); });
 }
 
 pplx::task<etcd::Response> etcd::Client::get(std::string const& key,
                                              int64_t revision) {
-  return etcd::detail::asyncify(
-      static_cast<etcd::responser_t<etcdv3::AsyncRangeAction>>(
-          Response::create),
-      this->client->get_internal(key, revision));
+  return this->coalesced_read(
+      SyncClient::read_signature("get", key, "", 0, revision),
+      [&]() { return this->client->get_internal(key, revision); });
+}
+
+pplx::task<etcd::Response> etcd::Client::get(std::string const& key,
+                                             ReadConsistency consistency) {
+  return this->coalesced_read(
+      SyncClient::read_signature("get", key, "", 0, 0), consistency,
+      [&]() { return this->client->get_internal(key, 0, consistency); });
+}
+
+pplx::task<std::vector<etcd::Response>> etcd::Client::get_many(
+    std::vector<std::string> const& keys, size_t const max_ops,
+    size_t const max_inflight) {
+  return pplx::task<std::vector<etcd::Response>>(
+      [this, keys, max_ops, max_inflight]() {
+        return this->client->get_many(keys, max_ops, max_inflight);
+      });
 }
 
 pplx::task<etcd::Response> etcd::Client::set(std::string const& key,
@@ -335,94 +398,239 @@ pplx::task<etcd::Response> etcd::Client::rmdir(std::string const& key,
       this->client->rmdir_internal(key, range_end));
 }
 
+pplx::task<etcd::Response> etcd::Client::rmdir_chunked(
+    std::string const& key, size_t const chunk_size, bool const prev_kv,
+    DeleteProgress const& progress) {
+  return pplx::task<etcd::Response>([this, key, chunk_size, prev_kv,
+                                     progress]() {
+    return this->client->rmdir_chunked(key, chunk_size, prev_kv, progress);
+  });
+}
+
+pplx::task<etcd::Response> etcd::Client::rmdir_chunked(
+    std::string const& key, std::string const& range_end,
+    size_t const chunk_size, bool const prev_kv,
+    DeleteProgress const& progress) {
+  return pplx::task<etcd::Response>(
+      [this, key, range_end, chunk_size, prev_kv, progress]() {
+        return this->client->rmdir_chunked(key, range_end, chunk_size, prev_kv,
+                                           progress);
+      });
+}
+
 pplx::task<etcd::Response> etcd::Client::ls(std::string const& key) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, 0));
+  return this->coalesced_read(
+      SyncClient::read_signature("ls", key, "", 0, 0),
+      [&]() { return this->client->ls_internal(key, 0); });
 }
 
 pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
                                             size_t const limit) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, limit));
+  return this->coalesced_read(
+      SyncClient::read_signature("ls", key, "", limit, 0),
+      [&]() { return this->client->ls_internal(key, limit); });
 }
 
 pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
                                             size_t const limit,
                                             int64_t revision) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, limit, false, revision));
+  return this->coalesced_read(
+      SyncClient::read_signature("ls", key, "", limit, revision),
+      [&]() { return this->client->ls_internal(key, limit, false, revision); });
 }
 
 pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
                                             std::string const& range_end) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, range_end, 0));
+  return this->coalesced_read(
+      SyncClient::read_signature("range", key, range_end, 0, 0),
+      [&]() { return this->client->ls_internal(key, range_end, 0); });
 }
 
 pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
                                             std::string const& range_end,
                                             size_t const limit) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, range_end, limit));
+  return this->coalesced_read(
+      SyncClient::read_signature("range", key, range_end, limit, 0),
+      [&]() { return this->client->ls_internal(key, range_end, limit); });
 }
 
 pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
                                             std::string const& range_end,
                                             size_t const limit,
                                             int64_t revision) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, range_end, limit, false, revision));
+  return this->coalesced_read(
+      SyncClient::read_signature("range", key, range_end, limit, revision),
+      [&]() {
+        return this->client->ls_internal(key, range_end, limit, false,
+                                         revision);
+      });
 }
 
 pplx::task<etcd::Response> etcd::Client::keys(std::string const& key) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, 0, true));
+  return this->coalesced_read(
+      SyncClient::read_signature("keys", key, "", 0, 0),
+      [&]() { return this->client->ls_internal(key, 0, true); });
 }
 
 pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
                                               size_t const limit) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, limit, true));
+  return this->coalesced_read(
+      SyncClient::read_signature("keys", key, "", limit, 0),
+      [&]() { return this->client->ls_internal(key, limit, true); });
 }
 
 pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
                                               size_t const limit,
                                               int64_t revision) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, limit, true, revision));
+  return this->coalesced_read(
+      SyncClient::read_signature("keys", key, "", limit, revision),
+      [&]() { return this->client->ls_internal(key, limit, true, revision); });
 }
 
 pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
                                               std::string const& range_end) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, range_end, 0, true));
+  return this->coalesced_read(
+      SyncClient::read_signature("range-keys", key, range_end, 0, 0),
+      [&]() { return this->client->ls_internal(key, range_end, 0, true); });
 }
 
 pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
                                               std::string const& range_end,
                                               size_t const limit) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, range_end, limit, true));
+  return this->coalesced_read(
+      SyncClient::read_signature("range-keys", key, range_end, limit, 0),
+      [&]() { return this->client->ls_internal(key, range_end, limit, true); });
 }
 
 pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
                                               std::string const& range_end,
                                               size_t const limit,
                                               int64_t revision) {
-  return etcd::detail::asyncify(
-      static_cast<responser_t<etcdv3::AsyncRangeAction>>(Response::create),
-      this->client->ls_internal(key, range_end, limit, true, revision));
+  return this->coalesced_read(
+      SyncClient::read_signature("range-keys", key, range_end, limit, revision),
+      [&]() {
+        return this->client->ls_internal(key, range_end, limit, true, revision);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::get(std::string const& key,
+                                             RangeOptions const& options) {
+  return this->coalesced_read(
+      SyncClient::read_signature("get", key, "", options),
+      [&]() {
+        return this->client->range_internal(key, "", false, false, options);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
+                                            RangeOptions const& options) {
+  return this->coalesced_read(
+      SyncClient::read_signature("ls", key, "", options),
+      [&]() {
+        return this->client->range_internal(key, "", true, false, options);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
+                                            std::string const& range_end,
+                                            RangeOptions const& options) {
+  return this->coalesced_read(
+      SyncClient::read_signature("range", key, range_end, options),
+      [&]() {
+        return this->client->range_internal(key, range_end, false, false,
+                                            options);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
+                                              RangeOptions const& options) {
+  return this->coalesced_read(
+      SyncClient::read_signature("keys", key, "", options),
+      [&]() {
+        return this->client->range_internal(key, "", true, true, options);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
+                                              std::string const& range_end,
+                                              RangeOptions const& options) {
+  return this->coalesced_read(
+      SyncClient::read_signature("range-keys", key, range_end, options),
+      [&]() {
+        return this->client->range_internal(key, range_end, false, true,
+                                            options);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::count(std::string const& key) {
+  return this->coalesced_read(
+      SyncClient::read_signature("count", key, "", 0, 0),
+      [&]() { return this->client->count_internal(key, "", true); });
+}
+
+pplx::task<etcd::Response> etcd::Client::count(std::string const& key,
+                                               std::string const& range_end) {
+  return this->coalesced_read(
+      SyncClient::read_signature("range-count", key, range_end, 0, 0),
+      [&]() { return this->client->count_internal(key, range_end, false); });
+}
+
+pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
+                                            ReadConsistency consistency) {
+  return this->coalesced_read(
+      SyncClient::read_signature("ls", key, "", 0, 0), consistency, [&]() {
+        return this->client->ls_internal(key, 0, false, 0, consistency);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::ls(std::string const& key,
+                                            std::string const& range_end,
+                                            ReadConsistency consistency) {
+  return this->coalesced_read(
+      SyncClient::read_signature("range", key, range_end, 0, 0), consistency,
+      [&]() {
+        return this->client->ls_internal(key, range_end, 0, false, 0,
+                                         consistency);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
+                                              ReadConsistency consistency) {
+  return this->coalesced_read(
+      SyncClient::read_signature("keys", key, "", 0, 0), consistency, [&]() {
+        return this->client->ls_internal(key, 0, true, 0, consistency);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::keys(std::string const& key,
+                                              std::string const& range_end,
+                                              ReadConsistency consistency) {
+  return this->coalesced_read(
+      SyncClient::read_signature("range-keys", key, range_end, 0, 0),
+      consistency, [&]() {
+        return this->client->ls_internal(key, range_end, 0, true, 0,
+                                         consistency);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::count(std::string const& key,
+                                               ReadConsistency consistency) {
+  return this->coalesced_read(
+      SyncClient::read_signature("count", key, "", 0, 0), consistency,
+      [&]() {
+        return this->client->count_internal(key, "", true, consistency);
+      });
+}
+
+pplx::task<etcd::Response> etcd::Client::count(std::string const& key,
+                                               std::string const& range_end,
+                                               ReadConsistency consistency) {
+  return this->coalesced_read(
+      SyncClient::read_signature("range-count", key, range_end, 0, 0),
+      consistency, [&]() {
+        return this->client->count_internal(key, range_end, false,
+                                            consistency);
+      });
 }
 
 pplx::task<etcd::Response> etcd::Client::watch(std::string const& key,
@@ -494,6 +702,36 @@ pplx::task<etcd::Response> etcd::Client::leases() {
       this->client->leases_internal());
 }
 
+pplx::task<std::vector<etcd::Response>> etcd::Client::leasegrant_batch(
+    std::vector<int> const& ttls, size_t const max_inflight) {
+  return pplx::task<std::vector<etcd::Response>>([this, ttls, max_inflight]() {
+    return this->client->leasegrant_batch(ttls, max_inflight);
+  });
+}
+
+pplx::task<std::vector<etcd::Response>> etcd::Client::leaserevoke_batch(
+    std::vector<int64_t> const& lease_ids, size_t const max_inflight) {
+  return pplx::task<std::vector<etcd::Response>>(
+      [this, lease_ids, max_inflight]() {
+        return this->client->leaserevoke_batch(lease_ids, max_inflight);
+      });
+}
+
+pplx::task<std::vector<etcd::Response>> etcd::Client::leasetimetolive_batch(
+    std::vector<int64_t> const& lease_ids, size_t const max_inflight) {
+  return pplx::task<std::vector<etcd::Response>>(
+      [this, lease_ids, max_inflight]() {
+        return this->client->leasetimetolive_batch(lease_ids, max_inflight);
+      });
+}
+
+pplx::task<std::vector<etcd::Response>> etcd::Client::leases_with_ttl(
+    size_t const max_inflight) {
+  return pplx::task<std::vector<etcd::Response>>([this, max_inflight]() {
+    return this->client->leases_with_ttl(max_inflight);
+  });
+}
+
 pplx::task<etcd::Response> etcd::Client::add_member(
     std::string const& peer_urls, bool is_learner) {
   return etcd::detail::asyncify(
@@ -590,6 +828,26 @@ pplx::task<etcd::Response> etcd::Client::campaign(std::string const& name,
       this->client->campaign_internal(name, lease_id, value));
 }
 
+pplx::task<etcd::Response> etcd::Client::campaign(
+    std::string const& name, int64_t lease_id, std::string const& value,
+    pplx::cancellation_token const& token) {
+  pplx::task_completion_event<Response> event;
+  std::shared_ptr<SyncClient::Campaigner> campaigner =
+      this->client->campaign(name, lease_id, value,
+                             [event](Response resp) { event.set(resp); });
+  if (token.is_cancelable()) {
+    std::weak_ptr<SyncClient::Campaigner> pending = campaigner;
+    token.register_callback([pending]() {
+      if (auto campaigner = pending.lock()) {
+        campaigner->Cancel();
+      }
+    });
+  }
+  // keep the campaigner alive until the campaign finishes
+  return pplx::create_task(event).then(
+      [campaigner](Response resp) { return resp; });
+}
+
 pplx::task<etcd::Response> etcd::Client::proclaim(std::string const& name,
                                                   int64_t lease_id,
                                                   std::string const& key,
@@ -611,6 +869,12 @@ std::unique_ptr<etcd::Client::Observer> etcd::Client::observe(
   return this->client->observe(name);
 }
 
+std::unique_ptr<etcd::Client::Observer> etcd::Client::observe(
+    std::string const& name, std::function<void(Response)> callback,
+    Executor const& executor) {
+  return this->client->observe(name, callback, executor);
+}
+
 pplx::task<etcd::Response> etcd::Client::resign(std::string const& name,
                                                 int64_t lease_id,
                                                 std::string const& key,
@@ -686,3 +950,145 @@ etcd::KeepAlive::KeepAlive(
     std::function<void(std::exception_ptr)> const& handler, int ttl,
     int64_t lease_id)
     : KeepAlive(*client.sync_client(), handler, ttl, lease_id) {}
+
+// concurrency recipes from the async client
+
+etcd::concurrency::Mutex::Mutex(Client const& client, std::string const& prefix)
+    : Mutex(*client.sync_client(), prefix) {}
+
+etcd::concurrency::Mutex::Mutex(Client const& client, std::string const& prefix,
+                                int64_t lease_id)
+    : Mutex(*client.sync_client(), prefix, lease_id) {}
+
+etcd::concurrency::Election::Election(Client const& client,
+                                      std::string const& prefix)
+    : Election(*client.sync_client(), prefix) {}
+
+etcd::concurrency::Election::Election(Client const& client,
+                                      std::string const& prefix,
+                                      int64_t lease_id)
+    : Election(*client.sync_client(), prefix, lease_id) {}
+
+etcd::concurrency::RWMutex::RWMutex(Client const& client,
+                                    std::string const& prefix)
+    : RWMutex(*client.sync_client(), prefix) {}
+
+etcd::concurrency::RWMutex::RWMutex(Client const& client,
+                                    std::string const& prefix,
+                                    int64_t lease_id)
+    : RWMutex(*client.sync_client(), prefix, lease_id) {}
+
+etcd::concurrency::Semaphore::Semaphore(Client const& client,
+                                        std::string const& prefix,
+                                        size_t const capacity)
+    : Semaphore(*client.sync_client(), prefix, capacity) {}
+
+etcd::concurrency::Semaphore::Semaphore(Client const& client,
+                                        std::string const& prefix,
+                                        size_t const capacity,
+                                        int64_t lease_id)
+    : Semaphore(*client.sync_client(), prefix, capacity, lease_id) {}
+
+etcd::LeaseBuckets::LeaseBuckets(Client const& client,
+                                 std::chrono::seconds const& granularity)
+    : LeaseBuckets(*client.sync_client(), granularity) {}
+
+etcd::BatchWriter::BatchWriter(Client const& client, size_t const max_inflight,
+                               Callback const& callback)
+    : BatchWriter(*client.sync_client(), max_inflight, callback) {}
+
+etcd::BatchReader::BatchReader(Client const& client, size_t const max_inflight,
+                               Callback const& callback)
+    : BatchReader(*client.sync_client(), max_inflight, callback) {}
+
+etcd::CoalescingWriter::CoalescingWriter(
+    Client const& client, std::chrono::microseconds const& window,
+    size_t const max_ops)
+    : CoalescingWriter(*client.sync_client(), window, max_ops) {}
+
+etcd::RangeIterator::RangeIterator(Client const& client,
+                                   std::string const& prefix,
+                                   size_t const page_size,
+                                   bool const keys_only,
+                                   int64_t const revision)
+    : RangeIterator(*client.sync_client(), prefix, page_size, keys_only,
+                    revision) {}
+
+etcd::RangeIterator::RangeIterator(Client const& client,
+                                   std::string const& key,
+                                   std::string const& range_end,
+                                   size_t const page_size,
+                                   bool const keys_only,
+                                   int64_t const revision)
+    : RangeIterator(*client.sync_client(), key, range_end, page_size,
+                    keys_only, revision) {}
+
+etcd::ParallelScan::ParallelScan(Client const& client,
+                                 std::string const& prefix,
+                                 size_t const partitions,
+                                 size_t const page_size,
+                                 bool const keys_only)
+    : ParallelScan(*client.sync_client(), prefix, partitions, page_size,
+                   keys_only) {}
+
+etcd::ParallelScan::ParallelScan(Client const& client,
+                                 std::string const& key,
+                                 std::string const& range_end,
+                                 size_t const partitions,
+                                 size_t const page_size,
+                                 bool const keys_only)
+    : ParallelScan(*client.sync_client(), key, range_end, partitions,
+                   page_size, keys_only) {}
+
+etcd::ParallelScan::ParallelScan(Client const& client,
+                                 std::string const& key,
+                                 std::string const& range_end,
+                                 std::vector<std::string> const& splits,
+                                 size_t const page_size,
+                                 bool const keys_only)
+    : ParallelScan(*client.sync_client(), key, range_end, splits, page_size,
+                   keys_only) {}
+
+etcd::PrefixCache::PrefixCache(Client const& client, std::string const& prefix)
+    : PrefixCache(*client.sync_client(), prefix) {}
+
+etcd::PrefixCache::PrefixCache(Client const& client, std::string const& prefix,
+                               std::string const& snapshot_path)
+    : PrefixCache(*client.sync_client(), prefix, snapshot_path) {}
+
+etcd::NegativeCache::NegativeCache(Client const& client,
+                                   std::string const& prefix,
+                                   size_t const max_keys,
+                                   size_t const max_bytes)
+    : NegativeCache(*client.sync_client(), prefix, max_keys, max_bytes) {}
+
+etcd::ReadThroughCache::ReadThroughCache(Client const& client,
+                                         std::chrono::milliseconds const& ttl,
+                                         size_t const max_bytes)
+    : ReadThroughCache(*client.sync_client(), ttl, max_bytes) {}
+
+etcd::ReadThroughCache::ReadThroughCache(Client const& client,
+                                         std::chrono::milliseconds const& ttl,
+                                         size_t const max_bytes,
+                                         std::string const& watch_prefix)
+    : ReadThroughCache(*client.sync_client(), ttl, max_bytes, watch_prefix) {}
+
+etcd::Snapshot::Snapshot(Client const& client, int64_t const revision)
+    : Snapshot(*client.sync_client(), revision) {}
+
+etcd::Session::Session(Client const& client, size_t const max_retries)
+    : Session(*client.sync_client(), max_retries) {}
+
+etcd::MultiKeyWatcher::MultiKeyWatcher(Client const& client,
+                                       std::function<void(Response)> callback)
+    : MultiKeyWatcher(*client.sync_client(), callback) {}
+
+etcd::MultiKeyWatcher::MultiKeyWatcher(
+    Client const& client, std::vector<std::string> const& keys,
+    std::vector<std::pair<std::string, std::string>> const& ranges,
+    std::function<void(Response)> callback)
+    : MultiKeyWatcher(*client.sync_client(), keys, ranges, callback) {}
+
+etcd::EventBus::EventBus(Client const& client, std::string const& prefix,
+                         size_t const history)
+    : EventBus(*client.sync_client(), prefix, history) {}
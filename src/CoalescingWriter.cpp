@@ -0,0 +1,114 @@
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "etcd/CoalescingWriter.hpp"
+#include "etcd/v3/Transaction.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+const size_t etcd::CoalescingWriter::DEFAULT_MAX_TXN_OPS;
+
+etcd::CoalescingWriter::CoalescingWriter(
+    SyncClient& client, std::chrono::microseconds const& window,
+    size_t const max_ops)
+    : client(client),
+      window(window),
+      max_ops(std::max(max_ops, static_cast<size_t>(1))),
+      txns(0),
+      ops(0) {
+  worker = std::thread([this]() { this->run(); });
+}
+
+etcd::CoalescingWriter::~CoalescingWriter() {
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    stopped = true;
+    cv.notify_all();
+  }
+  worker.join();
+}
+
+std::future<etcd::Response> etcd::CoalescingWriter::put(
+    std::string const& key, std::string const& value, const int64_t leaseId) {
+  return enqueue(Write{true, key, value, leaseId, std::promise<Response>()});
+}
+
+std::future<etcd::Response> etcd::CoalescingWriter::rm(std::string const& key) {
+  return enqueue(Write{false, key, "", 0, std::promise<Response>()});
+}
+
+void etcd::CoalescingWriter::flush() {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  // nothing to seal, the next batch still waits for its window
+  if (!batches.empty()) {
+    flushing = true;
+    cv.notify_all();
+  }
+}
+
+std::future<etcd::Response> etcd::CoalescingWriter::enqueue(Write&& write) {
+  std::future<Response> future = write.promise.get_future();
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  if (batches.empty() || batches.back().writes.size() >= max_ops ||
+      batches.back().keys.find(write.key) != batches.back().keys.end()) {
+    batches.emplace_back();
+    batches.back().start_timepoint = std::chrono::steady_clock::now();
+  }
+  batches.back().keys.insert(write.key);
+  batches.back().writes.emplace_back(std::move(write));
+  cv.notify_all();
+  return future;
+}
+
+void etcd::CoalescingWriter::run() {
+  std::unique_lock<std::mutex> scope_lock(mutex);
+  while (true) {
+    cv.wait(scope_lock, [this]() { return stopped || !batches.empty(); });
+    if (batches.empty()) {
+      // stopped, and all writes have been committed
+      return;
+    }
+    if (batches.size() == 1) {
+      // wait for more writes until the end of the window, unless the batch
+      // has been sealed
+      auto deadline = batches.front().start_timepoint + window;
+      cv.wait_until(scope_lock, deadline, [this]() {
+        return stopped || flushing || batches.size() > 1 ||
+               batches.front().writes.size() >= max_ops;
+      });
+    }
+    Batch batch = std::move(batches.front());
+    batches.pop_front();
+    if (batches.empty()) {
+      flushing = false;
+    }
+
+    scope_lock.unlock();
+    commit(batch);
+    scope_lock.lock();
+  }
+}
+
+void etcd::CoalescingWriter::commit(Batch& batch) {
+  etcdv3::Transaction txn;
+  for (auto const& write : batch.writes) {
+    if (write.is_put) {
+      txn.add_success_put(write.key, write.value, write.lease_id, true);
+    } else {
+      txn.add_success_delete(write.key, "", false, true);
+    }
+  }
+  Response resp = client.txn(txn);
+  txns += 1;
+  ops += batch.writes.size();
+
+  auto const& responses = resp.responses();
+  for (size_t index = 0; index < batch.writes.size(); ++index) {
+    if (responses.size() == batch.writes.size()) {
+      batch.writes[index].promise.set_value(responses[index]);
+    } else {
+      // the transaction failed as a whole
+      batch.writes[index].promise.set_value(resp);
+    }
+  }
+}
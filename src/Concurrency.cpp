@@ -0,0 +1,464 @@
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <sstream>
+
+#include "etcd/Concurrency.hpp"
+#include "etcd/KeepAlive.hpp"
+#include "etcd/Watcher.hpp"
+#include "etcd/v3/AsyncGRPC.hpp"
+#include "etcd/v3/Transaction.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+namespace etcd {
+namespace concurrency {
+namespace detail {
+struct WaitState {
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool cancelled = false;
+};
+
+// see: DefaultTTL of session in the Go client
+static const int DEFAULT_SESSION_TTL = 60;
+
+static std::string make_key(std::string const& prefix, int64_t lease_id) {
+  std::ostringstream ss;
+  ss << prefix << std::hex << lease_id;
+  return ss.str();
+}
+}  // namespace detail
+}  // namespace concurrency
+}  // namespace etcd
+
+etcd::concurrency::Recipe::Recipe(SyncClient& client, std::string const& prefix)
+    : client(client),
+      pfx(prefix + "/"),
+      session(client.leasekeepalive(detail::DEFAULT_SESSION_TTL)),
+      lease_id(session->Lease()),
+      state(std::make_shared<detail::WaitState>()) {}
+
+etcd::concurrency::Recipe::Recipe(SyncClient& client, std::string const& prefix,
+                                  int64_t lease_id)
+    : client(client),
+      pfx(prefix + "/"),
+      session(nullptr),
+      lease_id(lease_id),
+      state(std::make_shared<detail::WaitState>()) {}
+
+etcd::concurrency::Recipe::~Recipe() {
+  if (session) {
+    // the keys of the session will be removed together with the lease
+    session->Cancel();
+    client.leaserevoke(lease_id);
+  }
+}
+
+void etcd::concurrency::Recipe::cancel() {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  state->cancelled = true;
+  state->cv.notify_all();
+}
+
+bool etcd::concurrency::Recipe::consume_cancelled() {
+  std::lock_guard<std::mutex> lock(state->mutex);
+  bool cancelled = state->cancelled;
+  state->cancelled = false;
+  return cancelled;
+}
+
+etcd::Response etcd::concurrency::Recipe::create_key(std::string const& key,
+                                                     std::string const& value,
+                                                     int64_t& create_revision) {
+  etcdv3::Transaction txn;
+  txn.add_compare_create(key, 0);
+  txn.add_success_put(key, value, lease_id);
+  txn.add_failure_range(key);
+  Response resp = client.txn(txn);
+  if (resp.is_ok()) {
+    create_revision = resp.index();
+  } else if (resp.error_code() == ERROR_COMPARE_FAILED &&
+             !resp.values().empty()) {
+    // the key has already been created by this session
+    create_revision = resp.value().created_index();
+    resp._error_code = 0;
+    resp._error_message.clear();
+  }
+  return resp;
+}
+
+etcd::Response etcd::concurrency::Recipe::wait_deletes(
+    std::string const& prefix, int64_t max_create_revision, bool& waited) {
+  waited = false;
+  while (true) {
+    Response resp = this->ls_by_create(prefix, false /* last */,
+                                       true /* keys_only */,
+                                       max_create_revision);
+    if (!resp.is_ok() || resp.keys().empty()) {
+      return resp;
+    }
+    waited = true;
+    // watch the immediate predecessor only
+    if (!this->wait_delete(resp.key(0), resp.index() + 1)) {
+      return this->make_error(ERROR_ACTION_CANCELLED,
+                              "etcd-cpp-apiv3: acquisition cancelled");
+    }
+  }
+}
+
+etcd::Response etcd::concurrency::Recipe::acquire(
+    std::string const& key, std::string const& wait_prefix,
+    int64_t& create_revision) {
+  auto start_timepoint = std::chrono::high_resolution_clock::now();
+  Response resp = this->create_key(key, "", create_revision);
+  if (!resp.is_ok()) {
+    create_revision = 0;
+    return resp;
+  }
+
+  bool waited = false;
+  resp = this->wait_deletes(wait_prefix, create_revision - 1, waited);
+  this->consume_cancelled();
+  if (!resp.is_ok()) {
+    // leave the queue
+    client.rm(key);
+    create_revision = 0;
+    return resp;
+  }
+  if (waited) {
+    // make sure the session hasn't expired while waiting, the read must
+    // be neither stale nor coalesced
+    Response get_resp = Response::create(
+        client.get_internal(key, 0, ReadConsistency::LINEARIZABLE));
+    if (!get_resp.is_ok()) {
+      create_revision = 0;
+      return get_resp;
+    }
+  }
+  return this->make_response(etcdv3::LOCK_ACTION, create_revision, key,
+                             start_timepoint);
+}
+
+bool etcd::concurrency::Recipe::wait_delete(std::string const& key,
+                                            int64_t revision) {
+  bool stopped = false;
+  bool deleted = this->wait_event(
+      key, "", revision,
+      [](Event const& event) {
+        return event.event_type() == Event::EventType::DELETE_;
+      },
+      stopped);
+  // if the watch stopped unexpectedly, the caller will look up the
+  // predecessor again.
+  return deleted || stopped;
+}
+
+bool etcd::concurrency::Recipe::wait_event(
+    std::string const& key, std::string const& range_end, int64_t revision,
+    std::function<bool(Event const&)> const& predicate, bool& stopped) {
+  // the watch callbacks may outlive this frame, thus share the flags
+  struct WatchState {
+    bool satisfied = false;
+    bool stopped = false;
+  };
+  auto state = this->state;
+  auto watch_state = std::make_shared<WatchState>();
+
+  auto callback = [state, watch_state, predicate](Response resp) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    if (!resp.is_ok()) {
+      watch_state->stopped = true;
+    }
+    for (auto const& event : resp.events()) {
+      if (predicate(event)) {
+        watch_state->satisfied = true;
+      }
+    }
+    state->cv.notify_all();
+  };
+  auto wait_callback = [state, watch_state](bool) {
+    std::lock_guard<std::mutex> lock(state->mutex);
+    watch_state->stopped = true;
+    state->cv.notify_all();
+  };
+  std::unique_ptr<Watcher> watcher;
+  if (range_end.empty()) {
+    watcher.reset(
+        new Watcher(client, key, revision, callback, wait_callback, false));
+  } else {
+    watcher.reset(new Watcher(client, key, range_end, revision, callback,
+                              wait_callback));
+  }
+
+  bool satisfied = false;
+  {
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->cv.wait(lock, [&]() {
+      return state->cancelled || watch_state->satisfied ||
+             watch_state->stopped;
+    });
+    satisfied = watch_state->satisfied;
+    stopped = !satisfied && !state->cancelled;
+  }
+  // n.b.: the watcher must be cancelled outside the lock, as the callback
+  // requires it.
+  watcher.reset();
+  return satisfied;
+}
+
+etcd::Response etcd::concurrency::Recipe::ls_by_create(
+    std::string const& prefix, bool const first, bool const keys_only,
+    int64_t max_create_revision, size_t const limit) {
+  return Response::create(client.ls_by_create_internal(
+      prefix, first, keys_only, max_create_revision, limit));
+}
+
+etcd::Response etcd::concurrency::Recipe::make_response(
+    std::string const& action, int64_t index, std::string const& key,
+    std::chrono::high_resolution_clock::time_point const& start_timepoint)
+    const {
+  Response resp;
+  resp._action = action;
+  resp._index = index;
+  resp._lock_key = key;
+  resp._name = pfx;
+  resp._duration = etcd::detail::duration_till_now(start_timepoint);
+  return resp;
+}
+
+etcd::Response etcd::concurrency::Recipe::make_error(
+    int error_code, std::string const& error_message) const {
+  return Response(error_code, error_message);
+}
+
+etcd::concurrency::Mutex::Mutex(SyncClient& client, std::string const& prefix)
+    : Recipe(client, prefix) {}
+
+etcd::concurrency::Mutex::Mutex(SyncClient& client, std::string const& prefix,
+                                int64_t lease_id)
+    : Recipe(client, prefix, lease_id) {}
+
+etcd::Response etcd::concurrency::Mutex::lock() {
+  my_key = detail::make_key(pfx, this->lease());
+  return this->acquire(my_key, pfx, my_revision);
+}
+
+etcd::Response etcd::concurrency::Mutex::unlock() {
+  Response resp = client.rm(my_key);
+  my_revision = 0;
+  return resp;
+}
+
+etcd::concurrency::RWMutex::RWMutex(SyncClient& client,
+                                    std::string const& prefix)
+    : Recipe(client, prefix) {}
+
+etcd::concurrency::RWMutex::RWMutex(SyncClient& client,
+                                    std::string const& prefix,
+                                    int64_t lease_id)
+    : Recipe(client, prefix, lease_id) {}
+
+etcd::Response etcd::concurrency::RWMutex::rlock() {
+  // readers wait for the writers ahead only
+  read_key = detail::make_key(pfx + "read/", this->lease());
+  return this->acquire(read_key, pfx + "write/", read_revision);
+}
+
+etcd::Response etcd::concurrency::RWMutex::runlock() {
+  Response resp = client.rm(read_key);
+  read_revision = 0;
+  return resp;
+}
+
+etcd::Response etcd::concurrency::RWMutex::lock() {
+  // writers wait for both the readers and writers ahead
+  write_key = detail::make_key(pfx + "write/", this->lease());
+  return this->acquire(write_key, pfx, write_revision);
+}
+
+etcd::Response etcd::concurrency::RWMutex::unlock() {
+  Response resp = client.rm(write_key);
+  write_revision = 0;
+  return resp;
+}
+
+etcd::concurrency::Semaphore::Semaphore(SyncClient& client,
+                                        std::string const& prefix,
+                                        size_t const capacity)
+    : Recipe(client, prefix), cap(capacity) {}
+
+etcd::concurrency::Semaphore::Semaphore(SyncClient& client,
+                                        std::string const& prefix,
+                                        size_t const capacity,
+                                        int64_t lease_id)
+    : Recipe(client, prefix, lease_id), cap(capacity) {}
+
+etcd::Response etcd::concurrency::Semaphore::acquire() {
+  if (cap == 0) {
+    return this->make_error(etcdv3::ERROR_GRPC_INVALID_ARGUMENT,
+                            "etcd-cpp-apiv3: semaphore: zero capacity");
+  }
+  auto start_timepoint = std::chrono::high_resolution_clock::now();
+  my_key = detail::make_key(pfx, this->lease());
+  Response resp = this->create_key(my_key, "", my_revision);
+  if (!resp.is_ok()) {
+    my_revision = 0;
+    return resp;
+  }
+
+  while (true) {
+    // the holders are the first `capacity` contenders
+    Response holders =
+        this->ls_by_create(pfx, true /* first */, true /* keys_only */,
+                           my_revision - 1, cap);
+    if (!holders.is_ok() || holders.keys().size() < cap) {
+      resp = holders;
+      break;
+    }
+    Response predecessor = this->ls_by_create(
+        pfx, false /* last */, true /* keys_only */, my_revision - 1);
+    if (!predecessor.is_ok()) {
+      resp = predecessor;
+      break;
+    }
+    if (predecessor.keys().empty()) {
+      continue;
+    }
+
+    // n.b.: watch from the revision of the holders, to not miss the
+    // predecessor becoming a holder in between.
+    bool satisfied = false, stopped = false;
+    if (predecessor.key(0) == holders.keys().back()) {
+      // the first waiter: wait for any holder to leave
+      std::set<std::string> holder_keys(holders.keys().begin(),
+                                        holders.keys().end());
+      satisfied = this->wait_event(
+          pfx, etcdv3::detail::string_plus_one(pfx), holders.index() + 1,
+          [holder_keys](Event const& event) {
+            return event.event_type() == Event::EventType::DELETE_ &&
+                   holder_keys.find(event.kv().key()) != holder_keys.end();
+          },
+          stopped);
+    } else {
+      // otherwise, wait for the predecessor to leave, or to become a holder
+      satisfied = this->wait_event(
+          predecessor.key(0), "", holders.index() + 1,
+          [](Event const&) { return true; }, stopped);
+    }
+    if (!satisfied && !stopped) {
+      resp = this->make_error(ERROR_ACTION_CANCELLED,
+                              "etcd-cpp-apiv3: acquisition cancelled");
+      break;
+    }
+  }
+  this->consume_cancelled();
+  if (!resp.is_ok()) {
+    // leave the queue
+    client.rm(my_key);
+    my_revision = 0;
+    return resp;
+  }
+
+  // wake up the successor, which may have started to watch this key while
+  // it was still waiting, even if we didn't wait: a holder could have left
+  // between the successor's listing and ours. Also makes sure the session
+  // hasn't expired.
+  etcdv3::Transaction txn;
+  txn.add_compare_create(my_key, my_revision);
+  txn.add_success_put(my_key, "", this->lease());
+  resp = client.txn(txn);
+  if (!resp.is_ok()) {
+    my_revision = 0;
+    return resp;
+  }
+  return this->make_response(etcdv3::LOCK_ACTION, my_revision, my_key,
+                             start_timepoint);
+}
+
+etcd::Response etcd::concurrency::Semaphore::release() {
+  Response resp = client.rm(my_key);
+  my_revision = 0;
+  return resp;
+}
+
+etcd::concurrency::Election::Election(SyncClient& client,
+                                      std::string const& prefix)
+    : Recipe(client, prefix) {}
+
+etcd::concurrency::Election::Election(SyncClient& client,
+                                      std::string const& prefix,
+                                      int64_t lease_id)
+    : Recipe(client, prefix, lease_id) {}
+
+etcd::Response etcd::concurrency::Election::campaign(std::string const& value) {
+  auto start_timepoint = std::chrono::high_resolution_clock::now();
+  leader_key = detail::make_key(pfx, this->lease());
+  Response resp = this->create_key(leader_key, value, leader_revision);
+  if (!resp.is_ok()) {
+    leader_key.clear();
+    leader_revision = 0;
+    return resp;
+  }
+  if (resp.values().size() == 1 && resp.value().as_string() != value) {
+    // already campaigned by this session with another value
+    resp = this->proclaim(value);
+    if (!resp.is_ok()) {
+      this->resign();
+      return resp;
+    }
+  }
+
+  bool waited = false;
+  resp = this->wait_deletes(pfx, leader_revision - 1, waited);
+  if (!resp.is_ok()) {
+    // leave the queue, otherwise the key blocks the other candidates until
+    // the lease expires
+    this->consume_cancelled();
+    this->resign();
+    return resp;
+  }
+  this->consume_cancelled();
+  return this->make_response(etcdv3::CAMPAIGN_ACTION, leader_revision,
+                             leader_key, start_timepoint);
+}
+
+etcd::Response etcd::concurrency::Election::proclaim(std::string const& value) {
+  if (leader_key.empty()) {
+    return this->make_error(ERROR_KEY_NOT_FOUND,
+                            "etcd-cpp-apiv3: election: not leader");
+  }
+  etcdv3::Transaction txn;
+  txn.add_compare_create(leader_key, leader_revision);
+  txn.add_success_put(leader_key, value, this->lease());
+  Response resp = client.txn(txn);
+  if (resp.error_code() == ERROR_COMPARE_FAILED) {
+    leader_key.clear();
+    leader_revision = 0;
+    return this->make_error(ERROR_KEY_NOT_FOUND,
+                            "etcd-cpp-apiv3: election: not leader");
+  }
+  return resp;
+}
+
+etcd::Response etcd::concurrency::Election::resign() {
+  if (leader_key.empty()) {
+    return Response();
+  }
+  etcdv3::Transaction txn;
+  txn.add_compare_create(leader_key, leader_revision);
+  txn.add_success_delete(leader_key);
+  Response resp = client.txn(txn);
+  leader_key.clear();
+  leader_revision = 0;
+  return resp;
+}
+
+etcd::Response etcd::concurrency::Election::leader() {
+  Response resp =
+      this->ls_by_create(pfx, true /* first */, false /* keys_only */);
+  if (resp.is_ok() && resp.keys().empty()) {
+    return this->make_error(ERROR_KEY_NOT_FOUND,
+                            "etcd-cpp-apiv3: election: no leader");
+  }
+  return resp;
+}
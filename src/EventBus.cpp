@@ -0,0 +1,377 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#include "etcd/EventBus.hpp"
+#include "etcd/Watcher.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+const size_t etcd::EventBus::DEFAULT_HISTORY;
+
+struct etcd::EventBus::Subscriber {
+  explicit Subscriber(std::function<void(Response)> const& callback)
+      : callback(callback) {
+    worker = std::thread([this]() { this->run(); });
+  }
+
+  void push(Response const& resp) {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    if (!closed) {
+      queue.emplace_back(resp);
+      cv.notify_all();
+    }
+  }
+
+  void close() {
+    {
+      std::lock_guard<std::mutex> scope_lock(mutex);
+      closed = true;
+      queue.clear();
+      cv.notify_all();
+    }
+    worker.join();
+  }
+
+  void run() {
+    std::unique_lock<std::mutex> scope_lock(mutex);
+    while (true) {
+      cv.wait(scope_lock, [this]() { return closed || !queue.empty(); });
+      if (closed) {
+        return;
+      }
+      Response resp = std::move(queue.front());
+      queue.pop_front();
+
+      scope_lock.unlock();
+      callback(resp);
+      scope_lock.lock();
+    }
+  }
+
+  std::string prefix;
+  std::function<void(Response)> callback;
+
+  mutable std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<Response> queue;
+  bool closed = false;
+  std::thread worker;
+};
+
+struct etcd::EventBus::Node {
+  std::map<char, std::unique_ptr<Node, NodeDeleter>> children;
+  std::vector<std::shared_ptr<Subscriber>> subscribers;
+};
+
+void etcd::EventBus::NodeDeleter::operator()(etcd::EventBus::Node* node) {
+  if (node) {
+    delete node;
+  }
+}
+
+struct etcd::EventBus::Signal {
+  std::mutex mutex;
+  std::condition_variable cv;
+  // identifies the current watcher, stale wait callbacks are ignored
+  size_t generation = 0;
+  bool need_restart = false;
+  // the revision to resume from has been compacted
+  bool compacted = false;
+  bool stopped = false;
+
+  void request_restart(size_t const from_generation, bool const compacted) {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    if (from_generation == generation) {
+      this->need_restart = true;
+      this->compacted = this->compacted || compacted;
+      cv.notify_all();
+    }
+  }
+};
+
+etcd::EventBus::Subscription::~Subscription() {
+  bus->unsubscribe(subscriber);
+  subscriber->close();
+}
+
+size_t etcd::EventBus::Subscription::pending() const {
+  std::lock_guard<std::mutex> scope_lock(subscriber->mutex);
+  return subscriber->queue.size();
+}
+
+etcd::EventBus::EventBus(SyncClient& client, std::string const& prefix,
+                         size_t const history)
+    : client(client),
+      prefix(prefix),
+      history(history),
+      root(new Node()),
+      signal(std::make_shared<Signal>()) {
+  if (!this->watch()) {
+    signal->need_restart = true;
+  }
+  worker = std::thread([this]() { this->run(); });
+}
+
+etcd::EventBus::~EventBus() {
+  {
+    std::lock_guard<std::mutex> scope_lock(signal->mutex);
+    signal->stopped = true;
+    signal->cv.notify_all();
+  }
+  worker.join();
+  watcher.reset();
+}
+
+std::unique_ptr<etcd::EventBus::Subscription> etcd::EventBus::subscribe(
+    std::string const& prefix, std::function<void(Response)> callback,
+    int64_t const from_revision) {
+  if (prefix.compare(0, this->prefix.size(), this->prefix) != 0) {
+    return nullptr;
+  }
+  auto subscriber = std::make_shared<Subscriber>(callback);
+  subscriber->prefix = prefix;
+
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  if (from_revision > 0 && from_revision < history_start) {
+    subscriber->push(Response(etcdv3::ERROR_GRPC_OUT_OF_RANGE,
+                              "etcd-cpp-apiv3: the revision to replay from is "
+                              "older than the history of the event bus"));
+  } else if (from_revision > 0) {
+    for (auto const& batch : recent) {
+      if (batch.index() < from_revision) {
+        continue;
+      }
+      Response resp;
+      resp._action = batch._action;
+      resp._index = batch._index;
+      for (auto const& event : batch._events) {
+        if (event.kv().key().compare(0, prefix.size(), prefix) == 0) {
+          resp._events.emplace_back(event);
+        }
+      }
+      if (!resp._events.empty()) {
+        subscriber->push(resp);
+      }
+    }
+  }
+
+  // the live events follow the replayed ones, as both happen with the lock
+  // held
+  Node* node = root.get();
+  for (char const c : prefix) {
+    auto& child = node->children[c];
+    if (child == nullptr) {
+      child.reset(new Node());
+    }
+    node = child.get();
+  }
+  node->subscribers.emplace_back(subscriber);
+  subscriber_count += 1;
+  return std::unique_ptr<Subscription>(new Subscription(this, subscriber));
+}
+
+int64_t etcd::EventBus::revision() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return watched_revision;
+}
+
+int64_t etcd::EventBus::history_revision() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return history_start;
+}
+
+size_t etcd::EventBus::subscribers() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return subscriber_count;
+}
+
+void etcd::EventBus::unsubscribe(
+    std::shared_ptr<Subscriber> const& subscriber) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  std::vector<Node*> path{root.get()};
+  for (char const c : subscriber->prefix) {
+    auto iter = path.back()->children.find(c);
+    if (iter == path.back()->children.end()) {
+      return;
+    }
+    path.emplace_back(iter->second.get());
+  }
+  auto& subscribers = path.back()->subscribers;
+  for (auto iter = subscribers.begin(); iter != subscribers.end(); ++iter) {
+    if (*iter == subscriber) {
+      subscribers.erase(iter);
+      subscriber_count -= 1;
+      break;
+    }
+  }
+  // prunes the nodes that lead to no subscriber
+  for (size_t depth = path.size() - 1; depth > 0; --depth) {
+    Node* node = path[depth];
+    if (!node->subscribers.empty() || !node->children.empty()) {
+      break;
+    }
+    path[depth - 1]->children.erase(subscriber->prefix[depth - 1]);
+  }
+}
+
+void etcd::EventBus::apply(Response const& resp) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  auto const& events = resp.events();
+  size_t begin = 0;
+  while (begin < events.size()) {
+    // the events of a revision
+    int64_t const revision = events[begin].kv().modified_index();
+    size_t end = begin + 1;
+    while (end < events.size() &&
+           events[end].kv().modified_index() == revision) {
+      end += 1;
+    }
+
+    Response batch;
+    batch._action = resp._action;
+    batch._index = revision;
+    batch._events.assign(events.begin() + begin, events.begin() + end);
+
+    // routes each event to the subscribers of the prefixes of its key
+    std::unordered_map<Subscriber*, Response> routed;
+    std::vector<Subscriber*> order;
+    for (auto const& event : batch._events) {
+      std::string const& key = event.kv().key();
+      Node* node = root.get();
+      for (size_t depth = 0; node != nullptr; ++depth) {
+        for (auto const& subscriber : node->subscribers) {
+          auto iter = routed.find(subscriber.get());
+          if (iter == routed.end()) {
+            iter = routed.emplace(subscriber.get(), Response()).first;
+            iter->second._action = batch._action;
+            iter->second._index = revision;
+            order.emplace_back(subscriber.get());
+          }
+          iter->second._events.emplace_back(event);
+        }
+        if (depth == key.size()) {
+          break;
+        }
+        auto child = node->children.find(key[depth]);
+        node = child == node->children.end() ? nullptr : child->second.get();
+      }
+    }
+    for (Subscriber* subscriber : order) {
+      subscriber->push(routed[subscriber]);
+    }
+
+    recent.emplace_back(std::move(batch));
+    while (recent.size() > history) {
+      history_start = recent.front().index() + 1;
+      recent.pop_front();
+    }
+    watched_revision = std::max(watched_revision, revision);
+    begin = end;
+  }
+}
+
+void etcd::EventBus::advance(int64_t const revision) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  // no event under the prefix up to the revision, nothing to keep
+  watched_revision = std::max(watched_revision, revision);
+}
+
+void etcd::EventBus::broadcast(Response const& resp) {
+  std::vector<Node*> nodes{root.get()};
+  while (!nodes.empty()) {
+    Node* node = nodes.back();
+    nodes.pop_back();
+    for (auto const& subscriber : node->subscribers) {
+      subscriber->push(resp);
+    }
+    for (auto const& child : node->children) {
+      nodes.emplace_back(child.second.get());
+    }
+  }
+}
+
+bool etcd::EventBus::watch() {
+  size_t generation = 0;
+  bool compacted = false;
+  {
+    std::lock_guard<std::mutex> scope_lock(signal->mutex);
+    generation = ++signal->generation;
+    compacted = signal->compacted;
+  }
+  // stops routing the events of the previous watcher
+  watcher.reset();
+
+  int64_t revision = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    revision = watched_revision;
+  }
+  if (revision == 0 || compacted) {
+    Response head = client.head();
+    if (!head.is_ok()) {
+      return false;
+    }
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    if (revision != 0) {
+      this->broadcast(Response(etcdv3::ERROR_GRPC_OUT_OF_RANGE,
+                               "etcd-cpp-apiv3: the events since the revision "
+                               "have been compacted"));
+    }
+    recent.clear();
+    watched_revision = head.index();
+    history_start = head.index() + 1;
+    revision = head.index();
+  }
+  {
+    std::lock_guard<std::mutex> scope_lock(signal->mutex);
+    signal->compacted = false;
+  }
+
+  std::shared_ptr<Signal> shared_signal = this->signal;
+  watcher.reset(new Watcher(
+      client, prefix, revision + 1,
+      [this, generation](Response resp) {
+        if (!resp.is_ok()) {
+          // resumes from the same revision, unless it has been compacted
+          this->signal->request_restart(generation,
+                                        resp.compact_revision() > 0);
+        } else if (resp.events().empty()) {
+          // a progress notification
+          this->advance(resp.index());
+        } else {
+          this->apply(resp);
+        }
+      },
+      [shared_signal, generation](bool cancelled) {
+        if (!cancelled) {
+          shared_signal->request_restart(generation, false);
+        }
+      },
+      true, true));
+  return true;
+}
+
+void etcd::EventBus::run() {
+  while (true) {
+    {
+      std::unique_lock<std::mutex> scope_lock(signal->mutex);
+      signal->cv.wait(scope_lock, [this]() {
+        return signal->stopped || signal->need_restart;
+      });
+      if (signal->stopped) {
+        return;
+      }
+      signal->need_restart = false;
+    }
+    if (!this->watch()) {
+      // retry later, unless stopped
+      std::unique_lock<std::mutex> scope_lock(signal->mutex);
+      signal->need_restart = true;
+      signal->cv.wait_for(scope_lock, std::chrono::seconds(1),
+                          [this]() { return signal->stopped; });
+    }
+  }
+}
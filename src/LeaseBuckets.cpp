@@ -0,0 +1,109 @@
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+
+#include "etcd/LeaseBuckets.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+etcd::LeaseBuckets::LeaseBuckets(SyncClient& client,
+                                 std::chrono::seconds const& granularity)
+    : client(client),
+      window(std::max(granularity, std::chrono::seconds(1))) {}
+
+void etcd::LeaseBuckets::rollover(clock_type::time_point const& now) {
+  // the server will expire the leases of the past windows
+  buckets.erase(buckets.begin(), buckets.upper_bound(now));
+}
+
+etcd::Response etcd::LeaseBuckets::lease(int ttl, int64_t& lease_id) {
+  auto now = clock_type::now();
+  auto deadline = now + std::chrono::seconds(std::max(ttl, 1));
+
+  // round the deadline up to the end of its window
+  auto windows = (deadline.time_since_epoch() + window -
+                  clock_type::duration(1)) /
+                 window;
+  clock_type::time_point window_end(
+      std::chrono::duration_cast<clock_type::duration>(window * windows));
+
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    rollover(now);
+    auto iter = buckets.find(window_end);
+    if (iter != buckets.end()) {
+      lease_id = iter->second;
+      return Response();
+    }
+  }
+
+  // grant outside the lock, the ttl covers the rest of the window
+  auto lease_ttl =
+      std::chrono::duration_cast<std::chrono::seconds>(window_end - now);
+  if (window_end - now > lease_ttl) {
+    lease_ttl += std::chrono::seconds(1);
+  }
+  Response resp = client.leasegrant(static_cast<int>(lease_ttl.count()));
+  if (!resp.is_ok()) {
+    return resp;
+  }
+
+  int64_t granted = resp.value().lease();
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    auto inserted = buckets.emplace(window_end, granted);
+    lease_id = inserted.first->second;
+  }
+  if (lease_id != granted) {
+    // lost the race with another granting of the same window
+    client.leaserevoke(granted);
+  }
+  return resp;
+}
+
+template <typename F>
+etcd::Response etcd::LeaseBuckets::with_lease(int ttl, F const& fn) {
+  for (int retry = 0; /* retry at most once */; ++retry) {
+    int64_t lease_id = 0;
+    Response resp = this->lease(ttl, lease_id);
+    if (!resp.is_ok()) {
+      return resp;
+    }
+    resp = fn(lease_id);
+    if (resp.error_code() == etcdv3::ERROR_GRPC_NOT_FOUND && retry == 0) {
+      // the lease has gone (e.g., revoked by others), start a new bucket
+      this->forget(lease_id);
+      continue;
+    }
+    return resp;
+  }
+}
+
+etcd::Response etcd::LeaseBuckets::put(std::string const& key,
+                                       std::string const& value, int ttl) {
+  return with_lease(ttl, [&](int64_t lease_id) {
+    return client.put(key, value, lease_id);
+  });
+}
+
+etcd::Response etcd::LeaseBuckets::add(std::string const& key,
+                                       std::string const& value, int ttl) {
+  return with_lease(ttl, [&](int64_t lease_id) {
+    return client.add(key, value, lease_id);
+  });
+}
+
+void etcd::LeaseBuckets::forget(int64_t lease_id) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  for (auto iter = buckets.begin(); iter != buckets.end(); ++iter) {
+    if (iter->second == lease_id) {
+      buckets.erase(iter);
+      return;
+    }
+  }
+}
+
+size_t etcd::LeaseBuckets::size() {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  rollover(clock_type::now());
+  return buckets.size();
+}
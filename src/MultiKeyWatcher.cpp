@@ -0,0 +1,457 @@
+#include <algorithm>
+#include <chrono>
+#include <deque>
+
+#include <grpc++/grpc++.h>
+#include "proto/rpc.grpc.pb.h"
+
+#include "etcd/MultiKeyWatcher.hpp"
+#include "etcd/v3/AsyncGRPC.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+struct etcd::MultiKeyWatcher::Stream {
+  enum Op { CREATE = 0, READ = 1, WRITE = 2, FINISH = 3 };
+  struct Tag {
+    Op op;
+  };
+
+  Stream() : tags{{CREATE}, {READ}, {WRITE}, {FINISH}} {}
+
+  // writes the next request, with the lock of the watcher held
+  void flush() {
+    if (ready && !writing && !finishing && !outbox.empty()) {
+      writing = true;
+      stream->Write(outbox.front(), &tags[WRITE]);
+    }
+  }
+
+  // finishes the stream once no read or write is in flight, with the lock of
+  // the watcher held
+  void maybe_finish() {
+    if (!reading && !writing && !finishing) {
+      finishing = true;
+      stream->Finish(&status, &tags[FINISH]);
+    }
+  }
+
+  Tag tags[4];
+
+  std::unique_ptr<etcdserverpb::Watch::Stub> stub;
+  grpc::ClientContext context;
+  grpc::CompletionQueue cq;
+  grpc::Status status;
+  std::unique_ptr<grpc::ClientAsyncReaderWriter<etcdserverpb::WatchRequest,
+                                                etcdserverpb::WatchResponse>>
+      stream;
+  etcdserverpb::WatchResponse reply;
+  std::chrono::high_resolution_clock::time_point start_timepoint =
+      std::chrono::high_resolution_clock::now();
+
+  // at most one write is in flight, the rest wait here
+  std::deque<etcdserverpb::WatchRequest> outbox;
+  bool ready = false;
+  bool reading = false;
+  bool writing = false;
+  bool finishing = false;
+  // an error has been delivered to the callback
+  bool reported = false;
+};
+
+void etcd::MultiKeyWatcher::StreamDeleter::operator()(
+    etcd::MultiKeyWatcher::Stream* stream) {
+  if (stream) {
+    delete stream;
+  }
+}
+
+namespace etcd {
+namespace detail {
+static bool range_contains(std::pair<std::string, std::string> const& range,
+                           std::string const& key) {
+  return range.first <= key && (range.second.empty() || key < range.second);
+}
+}  // namespace detail
+}  // namespace etcd
+
+etcd::MultiKeyWatcher::MultiKeyWatcher(SyncClient& client,
+                                       std::function<void(Response)> callback)
+    : MultiKeyWatcher(client, {}, {}, callback) {}
+
+etcd::MultiKeyWatcher::MultiKeyWatcher(
+    SyncClient& client, std::vector<std::string> const& keys,
+    std::vector<std::pair<std::string, std::string>> const& ranges,
+    std::function<void(Response)> callback)
+    : client(client), callback(callback) {
+  stream.reset(new Stream());
+  stream->stub = etcdserverpb::Watch::NewStub(client.grpc_channel());
+  std::string const& auth_token = client.current_auth_token();
+  if (!auth_token.empty()) {
+    stream->context.AddMetadata("token", auth_token);
+  }
+  // n.b.: prepare first, as the completion may be consumed by the event loop
+  // before `AsyncWatch()` returns.
+  stream->stream = stream->stub->PrepareAsyncWatch(&stream->context,
+                                                   &stream->cq);
+  stream->stream->StartCall(&stream->tags[Stream::CREATE]);
+  worker = std::thread([this]() { this->run(); });
+
+  if (!keys.empty() || !ranges.empty()) {
+    this->add(keys, ranges);
+  }
+}
+
+etcd::MultiKeyWatcher::~MultiKeyWatcher() {
+  this->Cancel();
+  worker.join();
+}
+
+bool etcd::MultiKeyWatcher::add(std::string const& key) {
+  return this->add(std::vector<std::string>{key}, {});
+}
+
+bool etcd::MultiKeyWatcher::add(std::string const& key,
+                                std::string const& range_end) {
+  return this->add({}, {std::make_pair(key, range_end)});
+}
+
+bool etcd::MultiKeyWatcher::add(
+    std::vector<std::string> const& keys,
+    std::vector<std::pair<std::string, std::string>> const& ranges) {
+  // the new keys are watched from the current revision
+  Response head = client.head();
+  if (!head.is_ok()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  if (stopped) {
+    return false;
+  }
+  for (auto const& key : keys) {
+    added[to_range(key, "")] += 1;
+  }
+  for (auto const& range : ranges) {
+    added[to_range(range.first, range.second)] += 1;
+  }
+  this->reconcile(head.index());
+  return true;
+}
+
+bool etcd::MultiKeyWatcher::remove(std::string const& key) {
+  return this->remove(key, "");
+}
+
+bool etcd::MultiKeyWatcher::remove(std::string const& key,
+                                   std::string const& range_end) {
+  // the replacing watches start from the current revision, or the latest
+  // revision seen on the stream if it cannot be determined
+  Response head = client.head();
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  auto iter = added.find(to_range(key, range_end));
+  if (iter == added.end()) {
+    return false;
+  }
+  if (--iter->second == 0) {
+    added.erase(iter);
+  }
+  if (!stopped) {
+    this->reconcile(head.is_ok() ? head.index() : 0);
+  }
+  return true;
+}
+
+size_t etcd::MultiKeyWatcher::size() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  size_t count = 0;
+  for (auto const& item : added) {
+    count += item.second;
+  }
+  return count;
+}
+
+size_t etcd::MultiKeyWatcher::watches() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return merged.size();
+}
+
+size_t etcd::MultiKeyWatcher::replaced() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  size_t count = 0;
+  for (auto const& item : watches_by_id) {
+    if (item.second->retire_at != 0) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+bool etcd::MultiKeyWatcher::Wait() {
+  std::unique_lock<std::mutex> scope_lock(mutex);
+  cv.wait(scope_lock, [this]() { return stopped; });
+  return cancelled;
+}
+
+void etcd::MultiKeyWatcher::Cancel() {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  if (!stopped) {
+    cancelled = true;
+    stream->context.TryCancel();
+  }
+}
+
+bool etcd::MultiKeyWatcher::Stopped() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return stopped;
+}
+
+etcd::MultiKeyWatcher::Range etcd::MultiKeyWatcher::to_range(
+    std::string const& key, std::string const& range_end) {
+  if (range_end.empty()) {
+    return Range(key, key + '\0');
+  }
+  if (range_end == std::string(1, '\0')) {
+    return Range(key, "");
+  }
+  return Range(key, range_end);
+}
+
+void etcd::MultiKeyWatcher::reconcile(int64_t const revision) {
+  // not before the events that have been delivered
+  int64_t const from = std::max(revision, stream_revision);
+
+  // the union of the added ranges, which are ordered by the begin key
+  std::vector<Range> ranges;
+  for (auto const& item : added) {
+    Range const& range = item.first;
+    if (ranges.empty() || (!ranges.back().second.empty() &&
+                           ranges.back().second < range.first)) {
+      ranges.emplace_back(range);
+    } else if (!ranges.back().second.empty() &&
+               (range.second.empty() || ranges.back().second < range.second)) {
+      // overlapping or adjacent
+      ranges.back().second = range.second;
+    }
+  }
+
+  std::map<std::string, std::shared_ptr<Watch>> next;
+  for (auto const& range : ranges) {
+    auto iter = merged.find(range.first);
+    if (iter != merged.end() && iter->second->range == range) {
+      next.emplace(range.first, iter->second);
+      continue;
+    }
+
+    // the replaced watches deliver the events up to `from`
+    auto watch = std::make_shared<Watch>();
+    watch->id = next_watch_id++;
+    watch->range = range;
+    watch->revision = from;
+
+    etcdserverpb::WatchRequest request;
+    auto create = request.mutable_create_request();
+    create->set_key(range.first);
+    create->set_range_end(range.second.empty() ? std::string(1, '\0')
+                                               : range.second);
+    create->set_start_revision(from + 1);
+    create->set_prev_kv(true);
+    create->set_progress_notify(true);
+    create->set_watch_id(watch->id);
+    stream->outbox.emplace_back(std::move(request));
+
+    watches_by_id.emplace(watch->id, watch);
+    next.emplace(range.first, watch);
+  }
+
+  std::vector<std::shared_ptr<Watch>> replaced;
+  for (auto const& item : merged) {
+    auto iter = next.find(item.first);
+    if (iter == next.end() || iter->second != item.second) {
+      item.second->retire_at = from;
+      replaced.emplace_back(item.second);
+    }
+  }
+  merged.swap(next);
+  bool lagging = false;
+  for (auto const& watch : replaced) {
+    this->maybe_retire(watch);
+    lagging = lagging || watch->revision < watch->retire_at;
+  }
+  if (lagging) {
+    // rather than waiting for the periodic progress notifications, which
+    // are minutes apart
+    etcdserverpb::WatchRequest request;
+    request.mutable_progress_request();
+    stream->outbox.emplace_back(std::move(request));
+  }
+  stream->flush();
+}
+
+void etcd::MultiKeyWatcher::maybe_retire(std::shared_ptr<Watch> const& watch) {
+  if (watch->retire_at == 0 || watch->revision < watch->retire_at) {
+    return;
+  }
+  // the events that are still in flight are dropped, and delivered by the
+  // replacing watches
+  watches_by_id.erase(watch->id);
+  etcdserverpb::WatchRequest request;
+  request.mutable_cancel_request()->set_watch_id(watch->id);
+  stream->outbox.emplace_back(std::move(request));
+  stream->flush();
+}
+
+bool etcd::MultiKeyWatcher::covers(std::string const& key) const {
+  // the last merged range that begins before the key
+  auto iter = merged.upper_bound(key);
+  if (iter == merged.begin()) {
+    return false;
+  }
+  --iter;
+  return detail::range_contains(iter->second->range, key);
+}
+
+void etcd::MultiKeyWatcher::run() {
+  void* got_tag = nullptr;
+  bool ok = false;
+  while (stream->cq.Next(&got_tag, &ok)) {
+    Response resp;
+    bool deliver = false;
+    {
+      std::lock_guard<std::mutex> scope_lock(mutex);
+      switch (static_cast<Stream::Tag*>(got_tag)->op) {
+      case Stream::CREATE: {
+        if (ok) {
+          stream->ready = true;
+          stream->reading = true;
+          stream->stream->Read(&stream->reply, &stream->tags[Stream::READ]);
+          stream->flush();
+        } else {
+          stream->maybe_finish();
+        }
+        break;
+      }
+      case Stream::READ: {
+        if (ok) {
+          deliver = this->dispatch(resp);
+          stream->stream->Read(&stream->reply, &stream->tags[Stream::READ]);
+        } else {
+          stream->reading = false;
+          stream->maybe_finish();
+        }
+        break;
+      }
+      case Stream::WRITE: {
+        stream->writing = false;
+        if (ok) {
+          stream->outbox.pop_front();
+          stream->flush();
+        } else {
+          stream->outbox.clear();
+          stream->maybe_finish();
+        }
+        break;
+      }
+      case Stream::FINISH:
+      default: {
+        if (!cancelled && !stream->reported) {
+          // the stream is broken, tell the watcher
+          if (stream->status.ok()) {
+            resp = Response(etcdv3::ERROR_GRPC_CANCELLED,
+                            "etcd-cpp-apiv3: watch stream closed");
+          } else {
+            resp = Response(stream->status.error_code(),
+                            stream->status.error_message());
+          }
+          deliver = true;
+        }
+        stopped = true;
+        cv.notify_all();
+        stream->cq.Shutdown();
+        break;
+      }
+      }
+    }
+    if (deliver && callback) {
+      callback(resp);
+    }
+  }
+}
+
+bool etcd::MultiKeyWatcher::dispatch(Response& resp) {
+  etcdserverpb::WatchResponse const& reply = stream->reply;
+  stream_revision = std::max(stream_revision, reply.header().revision());
+  if (reply.watch_id() == -1 && reply.events_size() == 0 && !reply.created() &&
+      !reply.canceled()) {
+    // the response to a progress request: all watches on the stream have
+    // caught up with the revision (since etcd v3.4.25 and v3.5.8)
+    std::vector<std::shared_ptr<Watch>> retiring;
+    for (auto const& item : watches_by_id) {
+      item.second->revision =
+          std::max(item.second->revision, reply.header().revision());
+      if (item.second->retire_at != 0) {
+        retiring.emplace_back(item.second);
+      }
+    }
+    for (auto const& watch : retiring) {
+      this->maybe_retire(watch);
+    }
+    return false;
+  }
+  auto iter = watches_by_id.find(reply.watch_id());
+  if (iter == watches_by_id.end()) {
+    // a cancelled watch
+    return false;
+  }
+  std::shared_ptr<Watch> watch = iter->second;
+
+  if (reply.canceled()) {
+    // e.g., the revision to resume from has been compacted
+    etcdv3::AsyncWatchResponse v3resp;
+    v3resp.set_action(etcdv3::WATCH_ACTION);
+    v3resp.set_watch_id(reply.watch_id());
+    v3resp.ParseResponse(stream->reply);
+    if (v3resp.get_error_code() == 0) {
+      v3resp.set_error_code(etcdv3::ERROR_GRPC_CANCELLED);
+      v3resp.set_error_message(reply.cancel_reason());
+    }
+    resp = Response(v3resp, detail::duration_till_now(stream->start_timepoint));
+    stream->reported = true;
+    stream->context.TryCancel();
+    return true;
+  }
+
+  if (reply.events_size() == 0) {
+    if (!reply.created()) {
+      // a progress notification, sent once the watch has caught up
+      watch->revision = std::max(watch->revision, reply.header().revision());
+      this->maybe_retire(watch);
+    }
+    return false;
+  }
+
+  etcdserverpb::WatchResponse kept;
+  kept.mutable_header()->CopyFrom(reply.header());
+  kept.set_watch_id(reply.watch_id());
+  for (auto const& event : reply.events()) {
+    int64_t const event_revision = event.kv().mod_revision();
+    watch->revision = std::max(watch->revision, event_revision);
+    // a replaced watch leaves the later events to the replacing ones, and
+    // the keys that are no longer watched
+    if (watch->retire_at != 0 && (event_revision > watch->retire_at ||
+                                  !this->covers(event.kv().key()))) {
+      continue;
+    }
+    kept.add_events()->CopyFrom(event);
+  }
+  // the events of a revision are in the same response
+  this->maybe_retire(watch);
+  if (kept.events_size() == 0) {
+    return false;
+  }
+
+  etcdv3::AsyncWatchResponse v3resp;
+  v3resp.set_action(etcdv3::WATCH_ACTION);
+  v3resp.set_watch_id(kept.watch_id());
+  v3resp.ParseResponse(kept);
+  resp = Response(v3resp, detail::duration_till_now(stream->start_timepoint));
+  stream->start_timepoint = std::chrono::high_resolution_clock::now();
+  return true;
+}
@@ -0,0 +1,201 @@
+#include <algorithm>
+#include <iterator>
+
+#include "etcd/NegativeCache.hpp"
+#include "etcd/Watcher.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+const size_t etcd::NegativeCache::DEFAULT_MAX_KEYS;
+const size_t etcd::NegativeCache::DEFAULT_MAX_BYTES;
+const size_t etcd::NegativeCache::ENTRY_OVERHEAD;
+
+struct etcd::NegativeCache::Signal {
+  std::mutex mutex;
+  // identifies the current watcher, stale wait callbacks are ignored
+  size_t generation = 0;
+  // no watcher has been started yet, or it has been interrupted
+  bool broken = true;
+
+  bool healthy() {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    return !broken;
+  }
+
+  void fail(size_t const from_generation) {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    if (from_generation == generation) {
+      broken = true;
+    }
+  }
+};
+
+etcd::NegativeCache::NegativeCache(SyncClient& client,
+                                   std::string const& prefix,
+                                   size_t const max_keys,
+                                   size_t const max_bytes)
+    : client(client),
+      prefix(prefix),
+      max_keys(max_keys),
+      max_bytes(max_bytes),
+      signal(std::make_shared<Signal>()) {}
+
+etcd::NegativeCache::~NegativeCache() {
+  std::lock_guard<std::mutex> watch_lock(watch_mutex);
+  watcher.reset();
+}
+
+etcd::Response etcd::NegativeCache::get(std::string const& key) {
+  if (!this->covers(key)) {
+    return client.get(key);
+  }
+  if (this->ensure_watching()) {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    auto iter = entries.find(key);
+    if (iter != entries.end()) {
+      lru.splice(lru.end(), lru, iter->second);
+      hit_count += 1;
+
+      Response resp;
+      resp._action = etcdv3::GET_ACTION;
+      resp._index = watched_revision;
+      resp._error_code = etcdv3::ERROR_KEY_NOT_FOUND;
+      resp._error_message = "etcd-cpp-apiv3: key not found";
+      return resp;
+    }
+  }
+
+  miss_count += 1;
+  Response resp = client.get(key);
+  if (resp.error_code() == etcdv3::ERROR_KEY_NOT_FOUND) {
+    this->remember(key, resp.index());
+  }
+  return resp;
+}
+
+bool etcd::NegativeCache::absent(std::string const& key) {
+  if (!signal->healthy()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return entries.find(key) != entries.end();
+}
+
+void etcd::NegativeCache::clear() {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  lru.clear();
+  entries.clear();
+  used_bytes = 0;
+}
+
+size_t etcd::NegativeCache::size() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return entries.size();
+}
+
+size_t etcd::NegativeCache::bytes() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return used_bytes;
+}
+
+bool etcd::NegativeCache::covers(std::string const& key) const {
+  return key.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool etcd::NegativeCache::ensure_watching() {
+  if (signal->healthy()) {
+    return true;
+  }
+
+  std::lock_guard<std::mutex> watch_lock(watch_mutex);
+  size_t generation = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(signal->mutex);
+    if (!signal->broken) {
+      // restarted by another thread
+      return true;
+    }
+    generation = ++signal->generation;
+  }
+  // the callbacks of the watcher take the lock of the keys, thus the watcher
+  // is stopped before
+  watcher.reset();
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    watching = false;
+    lru.clear();
+    entries.clear();
+    used_bytes = 0;
+  }
+
+  Response head = client.head();
+  if (!head.is_ok()) {
+    return false;
+  }
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    watched_revision = head.index();
+    watching = true;
+  }
+  {
+    // a failure of the watcher below marks it as broken again
+    std::lock_guard<std::mutex> scope_lock(signal->mutex);
+    signal->broken = false;
+  }
+  std::shared_ptr<Signal> shared_signal = this->signal;
+  watcher.reset(new Watcher(
+      client, prefix, head.index() + 1,
+      [this, generation](Response resp) {
+        if (resp.is_ok()) {
+          this->apply(resp);
+        } else {
+          // e.g., the revision has been compacted
+          this->signal->fail(generation);
+        }
+      },
+      [shared_signal, generation](bool cancelled) {
+        if (!cancelled) {
+          shared_signal->fail(generation);
+        }
+      },
+      true));
+  return true;
+}
+
+void etcd::NegativeCache::remember(std::string const& key,
+                                   int64_t const revision) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  // the watch may have delivered a put after the revision of the read
+  if (!watching || revision < watched_revision || max_keys == 0) {
+    return;
+  }
+  if (entries.find(key) != entries.end()) {
+    return;
+  }
+  lru.emplace_back(key);
+  entries.emplace(key, std::prev(lru.end()));
+  used_bytes += key.size() + ENTRY_OVERHEAD;
+
+  while (!lru.empty() &&
+         (entries.size() > max_keys || used_bytes > max_bytes)) {
+    used_bytes -= lru.front().size() + ENTRY_OVERHEAD;
+    entries.erase(lru.front());
+    lru.pop_front();
+  }
+}
+
+void etcd::NegativeCache::apply(Response const& resp) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  for (auto const& event : resp.events()) {
+    Value const& kv = event.kv();
+    watched_revision = std::max(watched_revision, kv.modified_index());
+    if (event.event_type() != Event::EventType::PUT) {
+      continue;
+    }
+    auto iter = entries.find(kv.key());
+    if (iter != entries.end()) {
+      used_bytes -= kv.key().size() + ENTRY_OVERHEAD;
+      lru.erase(iter->second);
+      entries.erase(iter);
+    }
+  }
+}
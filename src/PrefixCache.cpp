@@ -0,0 +1,659 @@
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <unordered_map>
+#include <utility>
+
+#include "etcd/PrefixCache.hpp"
+#include "etcd/RangeIterator.hpp"
+#include "etcd/Watcher.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+struct etcd::PrefixCache::Signal {
+  std::mutex mutex;
+  std::condition_variable cv;
+  // identifies the current watcher, stale wait callbacks are ignored
+  size_t generation = 0;
+  bool need_resync = false;
+  // asks the watch for its progress
+  bool need_progress = false;
+  bool stopped = false;
+
+  void request_resync(size_t const from_generation) {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    if (from_generation == generation) {
+      need_resync = true;
+      cv.notify_all();
+    }
+  }
+
+  void request_progress() {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    need_progress = true;
+    cv.notify_all();
+  }
+};
+
+namespace etcd {
+namespace detail {
+static std::atomic<uint64_t> prefix_cache_ids{0};
+
+// identifies the format of snapshot files
+static const char SNAPSHOT_MAGIC[8] = {'E', 'T', 'C', 'D', 'P', 'C', '0', '1'};
+
+// a read-only view of a whole file, mapped into memory if possible
+class MappedFile {
+ public:
+  explicit MappedFile(std::string const& path) {
+#if defined(_WIN32)
+    std::ifstream in(path, std::ios::binary);
+    if (in) {
+      contents.assign(std::istreambuf_iterator<char>(in),
+                      std::istreambuf_iterator<char>());
+      data = contents.data();
+      size = contents.size();
+    }
+#else
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return;
+    }
+    struct stat status;
+    if (fstat(fd, &status) == 0 && status.st_size > 0) {
+      void* addr =
+          mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        data = static_cast<char const*>(addr);
+        size = status.st_size;
+      }
+    }
+    close(fd);
+#endif
+  }
+
+  ~MappedFile() {
+#if !defined(_WIN32)
+    if (data != nullptr) {
+      munmap(const_cast<char*>(data), size);
+    }
+#endif
+  }
+
+  MappedFile(MappedFile const&) = delete;
+
+  char const* data = nullptr;
+  size_t size = 0;
+
+ private:
+  std::string contents;
+};
+
+template <typename T>
+static bool read_field(char const*& cursor, char const* end, T& field) {
+  if (static_cast<size_t>(end - cursor) < sizeof(T)) {
+    return false;
+  }
+  std::memcpy(&field, cursor, sizeof(T));
+  cursor += sizeof(T);
+  return true;
+}
+
+static bool read_bytes(char const*& cursor, char const* end,
+                       size_t const length, std::string& bytes) {
+  if (static_cast<size_t>(end - cursor) < length) {
+    return false;
+  }
+  bytes.assign(cursor, length);
+  cursor += length;
+  return true;
+}
+
+// reads the magic, the revision, the number of keys and the prefix
+static bool read_header(char const*& cursor, char const* end,
+                        int64_t& revision, uint64_t& count,
+                        std::string& prefix) {
+  std::string magic;
+  uint32_t prefix_length = 0;
+  return read_bytes(cursor, end, sizeof(SNAPSHOT_MAGIC), magic) &&
+         magic.compare(0, magic.size(), SNAPSHOT_MAGIC,
+                       sizeof(SNAPSHOT_MAGIC)) == 0 &&
+         read_field(cursor, end, revision) && read_field(cursor, end, count) &&
+         read_field(cursor, end, prefix_length) &&
+         read_bytes(cursor, end, prefix_length, prefix);
+}
+
+template <typename T>
+static void write_field(std::ostream& out, T const& field) {
+  out.write(reinterpret_cast<char const*>(&field), sizeof(T));
+}
+}  // namespace detail
+}  // namespace etcd
+
+const size_t etcd::PrefixCache::Snapshot::CHUNK_SIZE;
+
+etcd::PrefixCache::Snapshot::const_iterator&
+etcd::PrefixCache::Snapshot::const_iterator::operator++() {
+  ++position;
+  if (position == (*chunks)[chunk]->end()) {
+    chunk += 1;
+    position = chunk < chunks->size() ? (*chunks)[chunk]->begin()
+                                      : Chunk::const_iterator();
+  }
+  return *this;
+}
+
+bool etcd::PrefixCache::Snapshot::get(std::string const& key,
+                                      std::string& value) const {
+  size_t index = this->locate(key);
+  return index != chunks.size() && chunks[index]->get(key, value);
+}
+
+etcd::Response etcd::PrefixCache::Snapshot::get(std::string const& key) const {
+  Response resp;
+  resp._action = etcdv3::GET_ACTION;
+  resp._index = this->snapshot_revision;
+  size_t index = this->locate(key);
+  if (index == chunks.size() || !chunks[index]->find(key, resp._value)) {
+    resp._error_code = etcdv3::ERROR_KEY_NOT_FOUND;
+    resp._error_message = "etcd-cpp-apiv3: key not found";
+  }
+  return resp;
+}
+
+etcd::Response etcd::PrefixCache::Snapshot::ls(
+    std::string const& prefix) const {
+  Response resp;
+  resp._action = etcdv3::GET_ACTION;
+  resp._index = this->snapshot_revision;
+  for (auto iter = this->lower_bound(prefix);
+       iter != this->end() &&
+       iter->key().compare(0, prefix.size(), prefix) == 0;
+       ++iter) {
+    resp._values.emplace_back(*iter);
+    resp._keys.emplace_back(iter->key());
+  }
+  if (!resp._values.empty()) {
+    resp._value = resp._values.front();
+  }
+  return resp;
+}
+
+etcd::Response etcd::PrefixCache::Snapshot::ls(
+    std::string const& key, std::string const& range_end) const {
+  Response resp;
+  resp._action = etcdv3::GET_ACTION;
+  resp._index = this->snapshot_revision;
+  // as `detail::make_request_with_ranges()`, "\0" is the beginning (as the
+  // key) or the end (as the range end) of the keyspace
+  std::string const from = key == etcdv3::NUL ? "" : key;
+  bool const to_end = range_end == etcdv3::NUL;
+  for (auto iter = this->lower_bound(from); iter != this->end(); ++iter) {
+    std::string const& current = iter->key();
+    if (range_end.empty() ? current != from
+                          : !to_end && current >= range_end) {
+      break;
+    }
+    resp._values.emplace_back(*iter);
+    resp._keys.emplace_back(current);
+  }
+  if (!resp._values.empty()) {
+    resp._value = resp._values.front();
+  }
+  return resp;
+}
+
+etcd::PrefixCache::Snapshot::const_iterator
+etcd::PrefixCache::Snapshot::begin() const {
+  return chunks.empty() ? this->end()
+                        : const_iterator(&chunks, 0, chunks[0]->begin());
+}
+
+etcd::PrefixCache::Snapshot::const_iterator
+etcd::PrefixCache::Snapshot::lower_bound(std::string const& key) const {
+  size_t index = this->locate(key);
+  if (index == chunks.size()) {
+    return this->end();
+  }
+  Chunk::const_iterator iter = chunks[index]->lower_bound(key);
+  if (iter == chunks[index]->end()) {
+    // the first key of the next chunk, or the end
+    index += 1;
+    iter = index < chunks.size() ? chunks[index]->begin()
+                                 : Chunk::const_iterator();
+  }
+  return const_iterator(&chunks, index, iter);
+}
+
+void etcd::PrefixCache::Snapshot::append(Value const& value) {
+  if (chunks.empty() || chunks.back()->size() >= CHUNK_SIZE) {
+    chunks.emplace_back(std::make_shared<Chunk>());
+  }
+  if (chunks.back()->insert(value)) {
+    entries += 1;
+  }
+}
+
+size_t etcd::PrefixCache::Snapshot::locate(std::string const& key) const {
+  if (chunks.empty()) {
+    return 0;
+  }
+  // the last chunk whose first key is not greater than the key
+  auto iter = std::upper_bound(
+      chunks.begin(), chunks.end(), key,
+      [](std::string const& key, std::shared_ptr<Chunk> const& chunk) {
+        return chunk->compare_first(key) < 0;
+      });
+  return iter == chunks.begin() ? 0 : (iter - chunks.begin()) - 1;
+}
+
+etcd::PrefixCache::PrefixCache(SyncClient& client, std::string const& prefix)
+    : PrefixCache(client, prefix, "") {}
+
+etcd::PrefixCache::PrefixCache(SyncClient& client, std::string const& prefix,
+                               std::string const& snapshot_path)
+    : client(client),
+      prefix(prefix),
+      snapshot_path(snapshot_path),
+      id(++detail::prefix_cache_ids),
+      current(std::make_shared<const Snapshot>()),
+      signal(std::make_shared<Signal>()) {
+  if (!this->restore() && !this->sync()) {
+    signal->need_resync = true;
+  }
+  worker = std::thread([this]() { this->run(); });
+}
+
+etcd::PrefixCache::~PrefixCache() {
+  {
+    std::lock_guard<std::mutex> scope_lock(signal->mutex);
+    signal->stopped = true;
+    signal->cv.notify_all();
+  }
+  worker.join();
+  watcher.reset();
+  if (snapshot_path.empty()) {
+    return;
+  }
+  // leaves the snapshot of another prefix in place
+  {
+    detail::MappedFile file(snapshot_path);
+    char const* cursor = file.data;
+    int64_t revision = 0;
+    uint64_t count = 0;
+    std::string saved_prefix;
+    if (file.data != nullptr &&
+        detail::read_header(cursor, file.data + file.size, revision, count,
+                            saved_prefix) &&
+        saved_prefix != prefix) {
+      return;
+    }
+  }
+  this->save(snapshot_path);
+}
+
+bool etcd::PrefixCache::save(std::string const& path) const {
+  std::shared_ptr<const Snapshot> snapshot = this->snapshot();
+  if (snapshot->revision() == 0) {
+    return false;
+  }
+
+  // writes aside, and then replaces the file, a reader never sees a
+  // partially written snapshot
+  std::string temporary = path + ".tmp";
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    out.write(detail::SNAPSHOT_MAGIC, sizeof(detail::SNAPSHOT_MAGIC));
+    detail::write_field(out, snapshot->revision());
+    detail::write_field(out, static_cast<uint64_t>(snapshot->size()));
+    detail::write_field(out, static_cast<uint32_t>(prefix.size()));
+    out.write(prefix.data(), prefix.size());
+    for (auto const& value : *snapshot) {
+      detail::write_field(out, static_cast<uint32_t>(value.key().size()));
+      detail::write_field(out,
+                          static_cast<uint32_t>(value.as_string().size()));
+      detail::write_field(out, value.created_index());
+      detail::write_field(out, value.modified_index());
+      detail::write_field(out, value.version());
+      detail::write_field(out, value.lease());
+      out.write(value.key().data(), value.key().size());
+      out.write(value.as_string().data(), value.as_string().size());
+    }
+    out.flush();
+    if (!out) {
+      std::remove(temporary.c_str());
+      return false;
+    }
+  }
+#if defined(_WIN32)
+  // rename() doesn't replace an existing file on Windows
+  std::remove(path.c_str());
+#endif
+  return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+std::shared_ptr<const etcd::PrefixCache::Snapshot>
+etcd::PrefixCache::snapshot() const {
+  return std::atomic_load(&this->current);
+}
+
+bool etcd::PrefixCache::get(std::string const& key, std::string& value) const {
+  return this->acquire().get(key, value);
+}
+
+etcd::Response etcd::PrefixCache::get(std::string const& key) const {
+  return this->acquire().get(key);
+}
+
+etcd::Response etcd::PrefixCache::ls(std::string const& prefix) const {
+  return this->acquire().ls(prefix);
+}
+
+etcd::Response etcd::PrefixCache::ls(std::string const& key,
+                                     std::string const& range_end) const {
+  return this->acquire().ls(key, range_end);
+}
+
+size_t etcd::PrefixCache::size() const { return this->acquire().size(); }
+
+int64_t etcd::PrefixCache::revision() const {
+  return this->acquire().revision();
+}
+
+bool etcd::PrefixCache::wait_for(int64_t revision,
+                                 std::chrono::milliseconds const& timeout) {
+  auto reached = [this, revision]() {
+    return std::atomic_load(&this->current)->revision() >= revision;
+  };
+  auto deadline = std::chrono::steady_clock::now() + timeout;
+  std::unique_lock<std::mutex> scope_lock(mutex);
+  while (!reached()) {
+    // the revision of a write outside the prefix only shows up in the
+    // progress of the watch, asks again in case the server dropped the
+    // request, e.g., the watch was not synced yet
+    signal->request_progress();
+    auto now = std::chrono::steady_clock::now();
+    if (now >= deadline) {
+      return false;
+    }
+    revision_cv.wait_until(scope_lock,
+                           std::min(deadline, now + std::chrono::seconds(1)),
+                           reached);
+  }
+  return true;
+}
+
+bool etcd::PrefixCache::sync() {
+  size_t generation = this->unwatch();
+
+  std::shared_ptr<Snapshot> loaded = std::make_shared<Snapshot>();
+  RangeIterator iter(client, prefix);
+  while (iter.has_next()) {
+    Response page = iter.next();
+    if (!page.is_ok()) {
+      return false;
+    }
+    // the pages are in key order
+    for (auto const& value : page.values()) {
+      loaded->append(value);
+    }
+  }
+  loaded->snapshot_revision = iter.revision();
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    this->publish(loaded);
+  }
+  this->watch(generation, loaded->snapshot_revision);
+  return true;
+}
+
+bool etcd::PrefixCache::restore() {
+  if (snapshot_path.empty()) {
+    return false;
+  }
+  detail::MappedFile file(snapshot_path);
+  if (file.data == nullptr) {
+    return false;
+  }
+  char const* cursor = file.data;
+  char const* end = file.data + file.size;
+
+  std::string saved_prefix;
+  int64_t revision = 0;
+  uint64_t count = 0;
+  if (!detail::read_header(cursor, end, revision, count, saved_prefix) ||
+      saved_prefix != prefix || revision <= 0) {
+    return false;
+  }
+
+  // the server has been rebuilt, and is behind the snapshot
+  Response head = client.head();
+  if (head.is_ok() && head.index() < revision) {
+    return false;
+  }
+
+  std::shared_ptr<Snapshot> loaded = std::make_shared<Snapshot>();
+  std::string previous_key;
+  for (uint64_t index = 0; index < count; ++index) {
+    uint32_t key_length = 0, value_length = 0;
+    Value value;
+    if (!detail::read_field(cursor, end, key_length) ||
+        !detail::read_field(cursor, end, value_length) ||
+        !detail::read_field(cursor, end, value.created) ||
+        !detail::read_field(cursor, end, value.modified) ||
+        !detail::read_field(cursor, end, value._version) ||
+        !detail::read_field(cursor, end, value.leaseId) ||
+        !detail::read_bytes(cursor, end, key_length, value._key) ||
+        !detail::read_bytes(cursor, end, value_length, value.value)) {
+      return false;
+    }
+    // the keys are saved in order
+    if (index > 0 && value._key <= previous_key) {
+      return false;
+    }
+    value._ttl = -1;
+    loaded->append(value);
+    previous_key.swap(value._key);
+  }
+  if (cursor != end) {
+    return false;
+  }
+  loaded->snapshot_revision = revision;
+
+  size_t generation = this->unwatch();
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    this->publish(loaded);
+  }
+  this->watch(generation, revision);
+  return true;
+}
+
+size_t etcd::PrefixCache::unwatch() {
+  size_t generation = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(signal->mutex);
+    generation = ++signal->generation;
+  }
+  // stops applying the events of the previous watcher
+  watcher.reset();
+  return generation;
+}
+
+void etcd::PrefixCache::watch(size_t const generation,
+                              int64_t const revision) {
+  std::shared_ptr<Signal> shared_signal = this->signal;
+  watcher.reset(new Watcher(
+      client, prefix, revision + 1,
+      [this, generation](Response resp) {
+        if (!resp.is_ok()) {
+          // e.g., the revision has been compacted
+          this->signal->request_resync(generation);
+        } else if (resp.events().empty()) {
+          // a progress notification
+          this->advance(resp.index());
+        } else {
+          this->apply(resp);
+        }
+      },
+      [shared_signal, generation](bool cancelled) {
+        if (!cancelled) {
+          shared_signal->request_resync(generation);
+        }
+      },
+      true, true));
+}
+
+void etcd::PrefixCache::apply(Response const& resp) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  std::shared_ptr<const Snapshot> base = std::atomic_load(&this->current);
+  // shares all chunks with the current snapshot, at first
+  std::shared_ptr<Snapshot> next = std::make_shared<Snapshot>(*base);
+  // the chunks copied by this update, which can be modified in place
+  std::set<Snapshot::Chunk const*> owned;
+
+  int64_t revision = base->revision();
+  for (auto const& event : resp.events()) {
+    Value const& kv = event.kv();
+    // for a delete, the mod revision of the kv is the revision of the delete
+    revision = std::max(revision, kv.modified_index());
+
+    bool const is_put = event.event_type() == Event::EventType::PUT;
+    size_t index = next->locate(kv.key());
+    if (index == next->chunks.size()) {
+      if (!is_put) {
+        continue;
+      }
+      next->chunks.emplace_back(std::make_shared<Snapshot::Chunk>());
+      owned.insert(next->chunks.back().get());
+    }
+    std::shared_ptr<Snapshot::Chunk>& chunk = next->chunks[index];
+    if (!is_put && !chunk->contains(kv.key())) {
+      continue;
+    }
+
+    // copy on write
+    if (owned.find(chunk.get()) == owned.end()) {
+      chunk = std::make_shared<Snapshot::Chunk>(*chunk);
+      owned.insert(chunk.get());
+    }
+    if (is_put) {
+      if (chunk->insert(kv)) {
+        next->entries += 1;
+      }
+    } else {
+      chunk->erase(kv.key());
+      next->entries -= 1;
+    }
+
+    if (chunk->empty()) {
+      owned.erase(chunk.get());
+      next->chunks.erase(next->chunks.begin() + index);
+    } else if (chunk->size() >= 2 * Snapshot::CHUNK_SIZE) {
+      auto head = std::make_shared<Snapshot::Chunk>();
+      auto tail = std::make_shared<Snapshot::Chunk>();
+      for (auto const& value : *chunk) {
+        (head->size() < Snapshot::CHUNK_SIZE ? head : tail)->insert(value);
+      }
+      owned.erase(chunk.get());
+      owned.insert(head.get());
+      owned.insert(tail.get());
+      chunk = head;
+      next->chunks.insert(next->chunks.begin() + index + 1, tail);
+    }
+  }
+  next->snapshot_revision = revision;
+  this->publish(next);
+}
+
+void etcd::PrefixCache::advance(int64_t const revision) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  std::shared_ptr<const Snapshot> base = std::atomic_load(&this->current);
+  if (revision <= base->revision()) {
+    return;
+  }
+  // the same keys (and chunks), at a later revision
+  std::shared_ptr<Snapshot> next = std::make_shared<Snapshot>(*base);
+  next->snapshot_revision = revision;
+  this->publish(next);
+}
+
+void etcd::PrefixCache::publish(std::shared_ptr<const Snapshot> const& next) {
+  std::atomic_store(&this->current, next);
+  this->version.fetch_add(1, std::memory_order_release);
+  revision_cv.notify_all();
+}
+
+etcd::PrefixCache::Snapshot const& etcd::PrefixCache::acquire() const {
+  // readers would contend on the reference count of the snapshot if they
+  // copied the shared pointer on every read, rather, each thread holds on to
+  // the snapshot it has seen last (per cache), and only reloads it once the
+  // version moves
+  struct Cached {
+    uint64_t version = 0;
+    std::shared_ptr<const Snapshot> snapshot;
+    // expires once the cache has gone
+    std::weak_ptr<Signal> owner;
+  };
+  static thread_local std::unordered_map<uint64_t, Cached> cached;
+
+  uint64_t version = this->version.load(std::memory_order_acquire);
+  auto iter = cached.find(this->id);
+  if (iter != cached.end() && iter->second.version == version) {
+    return *iter->second.snapshot;
+  }
+  // releases the snapshots of the caches that have been destroyed
+  for (auto entry = cached.begin(); entry != cached.end();) {
+    if (entry->second.owner.expired()) {
+      entry = cached.erase(entry);
+    } else {
+      ++entry;
+    }
+  }
+  Cached& slot = cached[this->id];
+  slot.snapshot = std::atomic_load(&this->current);
+  slot.version = version;
+  slot.owner = this->signal;
+  return *slot.snapshot;
+}
+
+void etcd::PrefixCache::run() {
+  while (true) {
+    bool need_resync = false;
+    {
+      std::unique_lock<std::mutex> scope_lock(signal->mutex);
+      signal->cv.wait(scope_lock, [this]() {
+        return signal->stopped || signal->need_resync ||
+               signal->need_progress;
+      });
+      if (signal->stopped) {
+        return;
+      }
+      need_resync = signal->need_resync;
+      signal->need_resync = false;
+      signal->need_progress = false;
+    }
+    if (!need_resync) {
+      if (watcher != nullptr) {
+        watcher->RequestProgress();
+      }
+    } else if (this->sync()) {
+      resync_count += 1;
+    } else {
+      // retry later, unless stopped
+      std::unique_lock<std::mutex> scope_lock(signal->mutex);
+      signal->need_resync = true;
+      signal->cv.wait_for(scope_lock, std::chrono::seconds(1),
+                          [this]() { return signal->stopped; });
+    }
+  }
+}
@@ -0,0 +1,336 @@
+#include <algorithm>
+
+#include "etcd/RadixTree.hpp"
+
+const uint32_t etcd::RadixTree::NIL;
+const uint32_t etcd::RadixTree::ROOT;
+
+etcd::RadixTree::RadixTree() : nodes(1) {}
+
+bool etcd::RadixTree::find(std::string const& key, Value& value) const {
+  uint32_t node = this->locate(key);
+  if (node == NIL || nodes[node].value == NIL) {
+    return false;
+  }
+  this->value_of(node, value);
+  return true;
+}
+
+bool etcd::RadixTree::get(std::string const& key, std::string& value) const {
+  uint32_t node = this->locate(key);
+  if (node == NIL || nodes[node].value == NIL) {
+    return false;
+  }
+  Payload const& payload = values[nodes[node].value];
+  value.assign(value_bytes, payload.offset, payload.length);
+  return true;
+}
+
+bool etcd::RadixTree::contains(std::string const& key) const {
+  uint32_t node = this->locate(key);
+  return node != NIL && nodes[node].value != NIL;
+}
+
+bool etcd::RadixTree::insert(Value const& value) {
+  std::string const& key = value.key();
+  uint32_t node = ROOT;
+  size_t depth = 0;
+  while (depth < key.size()) {
+    unsigned char byte = static_cast<unsigned char>(key[depth]);
+    uint32_t child = nodes[node].first_child;
+    while (child != NIL && first_byte(child) < byte) {
+      child = nodes[child].next_sibling;
+    }
+    if (child == NIL || first_byte(child) != byte) {
+      // a new leaf for the rest of the key
+      uint32_t leaf = this->allocate_node();
+      nodes[leaf].label_offset = labels.size();
+      nodes[leaf].label_length = key.size() - depth;
+      labels.append(key, depth, std::string::npos);
+      nodes[leaf].value = this->allocate_value(value);
+      this->link_child(node, leaf);
+      entries += 1;
+      return true;
+    }
+
+    Node const& edge = nodes[child];
+    size_t common = 1;
+    size_t limit = std::min<size_t>(edge.label_length, key.size() - depth);
+    while (common < limit &&
+           labels[edge.label_offset + common] == key[depth + common]) {
+      common += 1;
+    }
+    if (common < edge.label_length) {
+      // splits the edge, the lower half keeps the value and the children
+      uint32_t lower = this->allocate_node();
+      Node& upper = nodes[child];
+      nodes[lower].label_offset = upper.label_offset + common;
+      nodes[lower].label_length = upper.label_length - common;
+      nodes[lower].value = upper.value;
+      nodes[lower].first_child = upper.first_child;
+      nodes[lower].parent = child;
+      for (uint32_t grandchild = upper.first_child; grandchild != NIL;
+           grandchild = nodes[grandchild].next_sibling) {
+        nodes[grandchild].parent = lower;
+      }
+      upper.label_length = common;
+      upper.value = NIL;
+      upper.first_child = lower;
+    }
+    node = child;
+    depth += common;
+  }
+
+  if (nodes[node].value != NIL) {
+    this->assign_value(values[nodes[node].value], value);
+    this->maybe_compact();
+    return false;
+  }
+  nodes[node].value = this->allocate_value(value);
+  entries += 1;
+  return true;
+}
+
+bool etcd::RadixTree::erase(std::string const& key) {
+  uint32_t node = this->locate(key);
+  if (node == NIL || nodes[node].value == NIL) {
+    return false;
+  }
+  garbage += values[nodes[node].value].length;
+  values[nodes[node].value].length = 0;
+  free_values.emplace_back(nodes[node].value);
+  nodes[node].value = NIL;
+  entries -= 1;
+
+  // removes the leaves that no longer lead to a value
+  while (node != ROOT && nodes[node].value == NIL &&
+         nodes[node].first_child == NIL) {
+    uint32_t parent = nodes[node].parent;
+    this->unlink_child(parent, node);
+    garbage += nodes[node].label_length;
+    nodes[node] = Node();
+    free_nodes.emplace_back(node);
+    node = parent;
+  }
+
+  // merges a node without value into its only child
+  uint32_t child = nodes[node].first_child;
+  if (node != ROOT && nodes[node].value == NIL && child != NIL &&
+      nodes[child].next_sibling == NIL) {
+    std::string label =
+        labels.substr(nodes[node].label_offset, nodes[node].label_length) +
+        labels.substr(nodes[child].label_offset, nodes[child].label_length);
+    garbage += label.size();
+    nodes[node].label_offset = labels.size();
+    nodes[node].label_length = label.size();
+    labels.append(label);
+    nodes[node].value = nodes[child].value;
+    nodes[node].first_child = nodes[child].first_child;
+    for (uint32_t grandchild = nodes[node].first_child; grandchild != NIL;
+         grandchild = nodes[grandchild].next_sibling) {
+      nodes[grandchild].parent = node;
+    }
+    nodes[child] = Node();
+    free_nodes.emplace_back(child);
+  }
+
+  this->maybe_compact();
+  return true;
+}
+
+etcd::RadixTree::const_iterator etcd::RadixTree::lower_bound(
+    std::string const& key) const {
+  uint32_t node = ROOT;
+  size_t depth = 0;
+  while (depth < key.size()) {
+    unsigned char byte = static_cast<unsigned char>(key[depth]);
+    uint32_t child = nodes[node].first_child;
+    while (child != NIL && first_byte(child) < byte) {
+      child = nodes[child].next_sibling;
+    }
+    if (child == NIL) {
+      // all keys in the subtree are less than the key
+      return const_iterator(this, this->after(node));
+    }
+    Node const& edge = nodes[child];
+    size_t limit = std::min<size_t>(edge.label_length, key.size() - depth);
+    int compared = labels.compare(edge.label_offset, limit, key, depth, limit);
+    if (compared < 0) {
+      return const_iterator(this, this->after(child));
+    }
+    if (compared > 0 || limit < edge.label_length) {
+      // all keys in the subtree of the child are greater than the key
+      return const_iterator(this, this->first_in(child));
+    }
+    node = child;
+    depth += limit;
+  }
+  return const_iterator(this, this->first_in(node));
+}
+
+int etcd::RadixTree::compare_first(std::string const& key) const {
+  // follows the first children down to the first key
+  uint32_t node = ROOT;
+  size_t depth = 0;
+  while (nodes[node].value == NIL) {
+    node = nodes[node].first_child;
+    Node const& edge = nodes[node];
+    size_t limit = std::min<size_t>(edge.label_length, key.size() - depth);
+    int compared = labels.compare(edge.label_offset, limit, key, depth, limit);
+    if (compared != 0) {
+      return -compared;
+    }
+    if (limit < edge.label_length) {
+      // the key is a prefix of the first key
+      return -1;
+    }
+    depth += limit;
+  }
+  return depth < key.size() ? 1 : 0;
+}
+
+uint32_t etcd::RadixTree::locate(std::string const& key) const {
+  uint32_t node = ROOT;
+  size_t depth = 0;
+  while (depth < key.size()) {
+    unsigned char byte = static_cast<unsigned char>(key[depth]);
+    uint32_t child = nodes[node].first_child;
+    while (child != NIL && first_byte(child) < byte) {
+      child = nodes[child].next_sibling;
+    }
+    if (child == NIL || first_byte(child) != byte) {
+      return NIL;
+    }
+    Node const& edge = nodes[child];
+    if (edge.label_length > key.size() - depth ||
+        labels.compare(edge.label_offset, edge.label_length, key, depth,
+                       edge.label_length) != 0) {
+      return NIL;
+    }
+    node = child;
+    depth += edge.label_length;
+  }
+  return node;
+}
+
+uint32_t etcd::RadixTree::first_in(uint32_t node) const {
+  // a node without value always has children, except an empty root
+  while (node != NIL && nodes[node].value == NIL) {
+    node = nodes[node].first_child;
+  }
+  return node;
+}
+
+uint32_t etcd::RadixTree::after(uint32_t node) const {
+  while (node != ROOT) {
+    if (nodes[node].next_sibling != NIL) {
+      return this->first_in(nodes[node].next_sibling);
+    }
+    node = nodes[node].parent;
+  }
+  return NIL;
+}
+
+uint32_t etcd::RadixTree::next(uint32_t const node) const {
+  if (nodes[node].first_child != NIL) {
+    return this->first_in(nodes[node].first_child);
+  }
+  return this->after(node);
+}
+
+uint32_t etcd::RadixTree::allocate_node() {
+  if (!free_nodes.empty()) {
+    uint32_t node = free_nodes.back();
+    free_nodes.pop_back();
+    return node;
+  }
+  nodes.emplace_back();
+  return nodes.size() - 1;
+}
+
+uint32_t etcd::RadixTree::allocate_value(Value const& value) {
+  uint32_t index = 0;
+  if (!free_values.empty()) {
+    index = free_values.back();
+    free_values.pop_back();
+  } else {
+    values.emplace_back(Payload());
+    index = values.size() - 1;
+  }
+  values[index].length = 0;
+  this->assign_value(values[index], value);
+  return index;
+}
+
+void etcd::RadixTree::assign_value(Payload& payload, Value const& value) {
+  std::string const& bytes = value.as_string();
+  if (bytes.size() <= payload.length) {
+    // overwrites the previous value in place
+    garbage += payload.length - bytes.size();
+    value_bytes.replace(payload.offset, bytes.size(), bytes);
+  } else {
+    garbage += payload.length;
+    payload.offset = value_bytes.size();
+    value_bytes.append(bytes);
+  }
+  payload.length = bytes.size();
+  payload.ttl = value.ttl();
+  payload.created = value.created_index();
+  payload.modified = value.modified_index();
+  payload.version = value.version();
+  payload.lease = value.lease();
+}
+
+void etcd::RadixTree::value_of(uint32_t const node, Value& value) const {
+  // the labels on the path from the root make the key
+  size_t length = 0;
+  for (uint32_t step = node; step != ROOT; step = nodes[step].parent) {
+    length += nodes[step].label_length;
+  }
+  value._key.resize(length);
+  for (uint32_t step = node; step != ROOT; step = nodes[step].parent) {
+    length -= nodes[step].label_length;
+    labels.copy(&value._key[length], nodes[step].label_length,
+                nodes[step].label_offset);
+  }
+
+  Payload const& payload = values[nodes[node].value];
+  value.dir = false;
+  value.value.assign(value_bytes, payload.offset, payload.length);
+  value.created = payload.created;
+  value.modified = payload.modified;
+  value._version = payload.version;
+  value._ttl = payload.ttl;
+  value.leaseId = payload.lease;
+}
+
+void etcd::RadixTree::link_child(uint32_t const parent, uint32_t const child) {
+  nodes[child].parent = parent;
+  unsigned char byte = first_byte(child);
+  uint32_t* slot = &nodes[parent].first_child;
+  while (*slot != NIL && first_byte(*slot) < byte) {
+    slot = &nodes[*slot].next_sibling;
+  }
+  nodes[child].next_sibling = *slot;
+  *slot = child;
+}
+
+void etcd::RadixTree::unlink_child(uint32_t const parent,
+                                   uint32_t const child) {
+  uint32_t* slot = &nodes[parent].first_child;
+  while (*slot != child) {
+    slot = &nodes[*slot].next_sibling;
+  }
+  *slot = nodes[child].next_sibling;
+}
+
+void etcd::RadixTree::maybe_compact() {
+  if (garbage < 4096 || garbage < (labels.size() + value_bytes.size()) / 2) {
+    return;
+  }
+  RadixTree compacted;
+  for (auto const& value : *this) {
+    compacted.insert(value);
+  }
+  std::swap(*this, compacted);
+}
@@ -0,0 +1,255 @@
+#include <algorithm>
+
+#include "etcd/RangeIterator.hpp"
+#include "etcd/v3/Action.hpp"
+#include "etcd/v3/AsyncGRPC.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+etcd::RangeIterator::RangeIterator(SyncClient& client,
+                                   std::string const& prefix,
+                                   size_t const page_size,
+                                   bool const keys_only,
+                                   int64_t const revision)
+    : RangeIterator(client, prefix,
+                    prefix.empty() ? etcdv3::NUL
+                                   : etcdv3::detail::string_plus_one(prefix),
+                    page_size, keys_only, revision) {}
+
+etcd::RangeIterator::RangeIterator(SyncClient& client, std::string const& key,
+                                   std::string const& range_end,
+                                   size_t const page_size,
+                                   bool const keys_only,
+                                   int64_t const revision)
+    : client(client),
+      range_end(range_end),
+      page_size(std::max(page_size, static_cast<size_t>(1))),
+      keys_only(keys_only),
+      pinned_revision(std::max(revision, static_cast<int64_t>(0))) {
+  // an empty key starts from the beginning of the keyspace, the pages are
+  // linearizable, as a serializable read may be served by a member that
+  // hasn't applied the pinned revision yet
+  this->call = client.ls_internal(
+      key.empty() ? etcdv3::NUL : key, range_end, this->page_size, keys_only,
+      this->pinned_revision, ReadConsistency::LINEARIZABLE);
+}
+
+etcd::Response etcd::RangeIterator::next() {
+  if (!this->call) {
+    return Response();
+  }
+
+  Response page = Response::create(this->call);
+  this->call.reset();
+  if (!page.is_ok()) {
+    return page;
+  }
+  if (this->pinned_revision == 0) {
+    this->pinned_revision = page.index();
+  }
+  this->received += page.values().size();
+
+  // a short page is the last one
+  if (page.values().size() >= this->page_size) {
+    // the smallest key that is larger than the last one
+    std::string next_key = page.values().back().key() + etcdv3::NUL;
+    this->call =
+        client.ls_internal(next_key, range_end, page_size, keys_only,
+                           pinned_revision, ReadConsistency::LINEARIZABLE);
+  }
+  return page;
+}
+
+etcd::ParallelScan::ParallelScan(SyncClient& client, std::string const& prefix,
+                                 size_t const partitions,
+                                 size_t const page_size, bool const keys_only)
+    : ParallelScan(client, prefix,
+                   prefix.empty() ? etcdv3::NUL
+                                  : etcdv3::detail::string_plus_one(prefix),
+                   partitions, page_size, keys_only) {}
+
+etcd::ParallelScan::ParallelScan(SyncClient& client, std::string const& key,
+                                 std::string const& range_end,
+                                 size_t const partitions,
+                                 size_t const page_size, bool const keys_only)
+    : client(client),
+      key(key.empty() ? etcdv3::NUL : key),
+      range_end(range_end),
+      partitions(std::max(partitions, static_cast<size_t>(1))),
+      page_size(std::max(page_size, static_cast<size_t>(1))),
+      keys_only(keys_only) {}
+
+etcd::ParallelScan::ParallelScan(SyncClient& client, std::string const& key,
+                                 std::string const& range_end,
+                                 std::vector<std::string> const& splits,
+                                 size_t const page_size, bool const keys_only)
+    : ParallelScan(client, key, range_end, 1, page_size, keys_only) {
+  for (auto const& split_key : splits) {
+    // keep the split keys that are inside the range
+    if (split_key > this->key &&
+        (this->range_end == etcdv3::NUL || split_key < this->range_end)) {
+      this->split_keys.emplace_back(split_key);
+    }
+  }
+  std::sort(this->split_keys.begin(), this->split_keys.end());
+  this->split_keys.erase(
+      std::unique(this->split_keys.begin(), this->split_keys.end()),
+      this->split_keys.end());
+}
+
+etcd::Response etcd::ParallelScan::scan(Callback const& callback,
+                                        bool const ordered) {
+  // the first key of the range, and the revision to read at, all reads are
+  // linearizable (the sub-ranges through `RangeIterator`), to not reach a
+  // member that lags behind the pinned revision
+  etcd::Response first = Response::create(client.ls_internal(
+      key, range_end, 1, true, 0, ReadConsistency::LINEARIZABLE));
+  if (!first.is_ok()) {
+    return first;
+  }
+  this->pinned_revision = first.index();
+  if (first.keys().empty()) {
+    return first;
+  }
+  if (this->split_keys.empty() && this->partitions > 1) {
+    etcd::Response resp = this->split(first.keys()[0]);
+    if (!resp.is_ok()) {
+      return resp;
+    }
+  }
+
+  // one iterator per sub-range, with its first page in flight
+  std::vector<std::unique_ptr<RangeIterator>> iterators;
+  for (size_t index = 0; index <= split_keys.size(); ++index) {
+    iterators.emplace_back(new RangeIterator(
+        client, index == 0 ? key : split_keys[index - 1],
+        index == split_keys.size() ? range_end : split_keys[index], page_size,
+        keys_only, pinned_revision));
+  }
+
+  std::vector<std::vector<Response>> buffered(iterators.size());
+  size_t delivering = 0;  // the sub-range to deliver next, if ordered
+  bool pending = true;
+  while (pending) {
+    pending = false;
+    for (size_t index = 0; index < iterators.size(); ++index) {
+      if (!iterators[index]->has_next()) {
+        continue;
+      }
+      etcd::Response page = iterators[index]->next();
+      if (!page.is_ok()) {
+        return page;
+      }
+      this->received += page.values().size();
+      pending = pending || iterators[index]->has_next();
+      if (page.values().empty()) {
+        continue;
+      }
+      if (!ordered || index == delivering) {
+        callback(page);
+      } else {
+        buffered[index].emplace_back(page);
+      }
+    }
+    // the following sub-ranges become deliverable once the current one is
+    // exhausted
+    while (ordered && delivering < iterators.size() &&
+           !iterators[delivering]->has_next()) {
+      delivering += 1;
+      if (delivering < iterators.size()) {
+        for (auto const& page : buffered[delivering]) {
+          callback(page);
+        }
+        buffered[delivering].clear();
+      }
+    }
+  }
+  return etcd::Response();
+}
+
+etcd::Response etcd::ParallelScan::split(std::string const& first_key) {
+  auto probe = [this](std::string const& from, std::string const& to,
+                      bool const count_only, bool const last) {
+    etcdv3::ActionParameters params;
+    params.key.assign(from);
+    params.range_end.assign(to);
+    params.revision = this->pinned_revision;
+    params.keys_only = true;
+    params.count_only = count_only;
+    if (last) {
+      params.limit = 1;
+      params.sort_target = etcdserverpb::RangeRequest::KEY;
+      params.sort_order = etcdserverpb::RangeRequest::DESCEND;
+    }
+    return this->client.range_internal(params);
+  };
+
+  // the last key, and the number of keys, of the range
+  auto last_call = probe(key, range_end, false, true);
+  auto total_call = probe(key, range_end, true, false);
+  last_call->waitForResponse();
+  total_call->waitForResponse();
+  auto last = last_call->ParseResponse();
+  auto total = total_call->ParseResponse();
+  if (last.get_error_code() != 0 || last.get_values().empty()) {
+    return Response(last, std::chrono::microseconds::zero());
+  }
+  if (total.get_error_code() != 0) {
+    return Response(total, std::chrono::microseconds::zero());
+  }
+  std::string const& last_key = last.get_values()[0].kvs.key();
+  if (static_cast<size_t>(total.get_count()) <= page_size) {
+    // a single page
+    return Response();
+  }
+
+  // all keys in the range share the common prefix of the first and last key,
+  // split on the byte that follows it
+  size_t common = 0;
+  while (common < first_key.size() && first_key[common] == last_key[common]) {
+    common += 1;
+  }
+  if (common == last_key.size()) {
+    return Response();
+  }
+  std::string prefix = last_key.substr(0, common);
+  int low = common < first_key.size()
+                ? static_cast<unsigned char>(first_key[common]) + 1
+                : 0;
+  int high = static_cast<unsigned char>(last_key[common]);
+
+  // the boundaries of the buckets: [key, prefix + low), [prefix + low,
+  // prefix + low + 1), ..., [prefix + high, range_end)
+  std::vector<std::string> boundaries{key};
+  for (int byte = low; byte <= high; ++byte) {
+    boundaries.emplace_back(prefix + static_cast<char>(byte));
+  }
+  boundaries.emplace_back(range_end);
+
+  std::vector<std::shared_ptr<etcdv3::AsyncRangeAction>> calls;
+  for (size_t index = 0; index + 1 < boundaries.size(); ++index) {
+    calls.emplace_back(
+        probe(boundaries[index], boundaries[index + 1], true, false));
+  }
+  std::vector<int64_t> counts;
+  for (auto& call : calls) {
+    call->waitForResponse();
+    auto resp = call->ParseResponse();
+    if (resp.get_error_code() != 0) {
+      return Response(resp, std::chrono::microseconds::zero());
+    }
+    counts.emplace_back(resp.get_count());
+  }
+
+  // cut when a sub-range reaches its share of the keys, a bucket is never
+  // split, thus a skewed range may end up with fewer sub-ranges
+  int64_t share = total.get_count() / partitions;
+  int64_t accumulated = 0;
+  for (size_t index = 0; index + 1 < counts.size(); ++index) {
+    accumulated += counts[index];
+    if (accumulated >= share && split_keys.size() + 1 < partitions) {
+      split_keys.emplace_back(boundaries[index + 1]);
+      accumulated = 0;
+    }
+  }
+  return Response();
+}
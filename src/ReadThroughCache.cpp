@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <iterator>
+
+#include "etcd/ReadThroughCache.hpp"
+#include "etcd/Watcher.hpp"
+#include "etcd/v3/Transaction.hpp"
+#include "etcd/v3/action_constants.hpp"
+
+const size_t etcd::ReadThroughCache::DEFAULT_MAX_BYTES;
+const size_t etcd::ReadThroughCache::ENTRY_OVERHEAD;
+
+etcd::ReadThroughCache::ReadThroughCache(SyncClient& client,
+                                         std::chrono::milliseconds const& ttl,
+                                         size_t const max_bytes)
+    : client(client), ttl(ttl), max_bytes(max_bytes) {
+  worker = std::thread([this]() { this->run(); });
+}
+
+etcd::ReadThroughCache::ReadThroughCache(SyncClient& client,
+                                         std::chrono::milliseconds const& ttl,
+                                         size_t const max_bytes,
+                                         std::string const& watch_prefix)
+    : ReadThroughCache(client, ttl, max_bytes) {
+  watcher.reset(new Watcher(
+      client, watch_prefix,
+      [this](Response resp) {
+        if (resp.is_ok()) {
+          this->apply(resp);
+        }
+      },
+      true));
+}
+
+etcd::ReadThroughCache::~ReadThroughCache() {
+  watcher.reset();
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    stopped = true;
+    cv.notify_all();
+  }
+  worker.join();
+}
+
+etcd::Response etcd::ReadThroughCache::get(std::string const& key) {
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    auto iter = entries.find(key);
+    if (iter != entries.end()) {
+      Entry& entry = iter->second;
+      lru.splice(lru.end(), lru, entry.position);
+      if (clock_type::now() < entry.expires) {
+        hit_count += 1;
+      } else {
+        stale_count += 1;
+        if (!entry.revalidating) {
+          entry.revalidating = true;
+          pending.emplace_back(key);
+          cv.notify_all();
+        }
+      }
+      return this->respond(entry);
+    }
+  }
+
+  miss_count += 1;
+  Response resp = client.get(key);
+  if (resp.is_ok()) {
+    this->store(key, resp.value(), resp.index());
+  }
+  return resp;
+}
+
+void etcd::ReadThroughCache::invalidate(std::string const& key) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  auto iter = entries.find(key);
+  if (iter != entries.end()) {
+    this->evict(iter);
+  }
+}
+
+void etcd::ReadThroughCache::clear() {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  entries.clear();
+  lru.clear();
+  used_bytes = 0;
+}
+
+size_t etcd::ReadThroughCache::size() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return entries.size();
+}
+
+size_t etcd::ReadThroughCache::bytes() const {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  return used_bytes;
+}
+
+void etcd::ReadThroughCache::store(std::string const& key, Value const& value,
+                                   int64_t const index) {
+  size_t bytes = key.size() + value.as_string().size() + ENTRY_OVERHEAD;
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  // the read may have missed a change that has been evicted by the watch
+  if (index < watched_revision || bytes > max_bytes) {
+    return;
+  }
+  auto iter = entries.find(key);
+  if (iter != entries.end()) {
+    this->evict(iter);
+  }
+  lru.emplace_back(key);
+  entries.emplace(key, Entry{value, index, clock_type::now() + ttl, false,
+                             bytes, std::prev(lru.end())});
+  used_bytes += bytes;
+
+  while (used_bytes > max_bytes && !lru.empty()) {
+    this->evict(entries.find(lru.front()));
+  }
+}
+
+void etcd::ReadThroughCache::evict(
+    std::unordered_map<std::string, Entry>::iterator iter) {
+  used_bytes -= iter->second.bytes;
+  lru.erase(iter->second.position);
+  entries.erase(iter);
+}
+
+etcd::Response etcd::ReadThroughCache::respond(Entry const& entry) const {
+  Response resp;
+  resp._action = etcdv3::GET_ACTION;
+  resp._index = entry.index;
+  resp._value = entry.value;
+  return resp;
+}
+
+void etcd::ReadThroughCache::run() {
+  std::unique_lock<std::mutex> scope_lock(mutex);
+  while (true) {
+    cv.wait(scope_lock, [this]() { return stopped || !pending.empty(); });
+    if (stopped) {
+      return;
+    }
+    std::string key = std::move(pending.front());
+    pending.pop_front();
+
+    scope_lock.unlock();
+    this->revalidate(key);
+    scope_lock.lock();
+  }
+}
+
+void etcd::ReadThroughCache::revalidate(std::string const& key) {
+  int64_t mod_revision = 0;
+  {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    auto iter = entries.find(key);
+    if (iter == entries.end()) {
+      return;
+    }
+    mod_revision = iter->second.value.modified_index();
+  }
+
+  // reads the key only if it has changed
+  etcdv3::Transaction txn;
+  txn.add_compare_mod(key, mod_revision);
+  txn.add_failure_range(key);
+  Response resp = client.txn(txn);
+
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  auto iter = entries.find(key);
+  if (iter == entries.end() ||
+      iter->second.value.modified_index() != mod_revision) {
+    // evicted, or replaced, in the meantime
+    revalidation_count += 1;
+    return;
+  }
+  Entry& entry = iter->second;
+  if (resp.is_ok()) {
+    entry.index = std::max(entry.index, resp.index());
+    entry.expires = clock_type::now() + ttl;
+    entry.revalidating = false;
+  } else if (resp.error_code() == etcdv3::ERROR_COMPARE_FAILED &&
+             !resp.values().empty() && resp.index() >= watched_revision) {
+    Value const& value = resp.values()[0];
+    size_t bytes = key.size() + value.as_string().size() + ENTRY_OVERHEAD;
+    used_bytes = used_bytes - entry.bytes + bytes;
+    entry.value = value;
+    entry.index = resp.index();
+    entry.expires = clock_type::now() + ttl;
+    entry.revalidating = false;
+    entry.bytes = bytes;
+    while (used_bytes > max_bytes && !lru.empty()) {
+      this->evict(entries.find(lru.front()));
+    }
+  } else if (resp.error_code() == etcdv3::ERROR_COMPARE_FAILED) {
+    // deleted
+    this->evict(iter);
+  } else {
+    // keeps serving the stale value, and retries on the next read
+    entry.revalidating = false;
+  }
+  // counted once the result is visible to the readers
+  revalidation_count += 1;
+}
+
+void etcd::ReadThroughCache::apply(Response const& resp) {
+  std::lock_guard<std::mutex> scope_lock(mutex);
+  for (auto const& event : resp.events()) {
+    Value const& kv = event.kv();
+    watched_revision = std::max(watched_revision, kv.modified_index());
+    auto iter = entries.find(kv.key());
+    if (iter != entries.end()) {
+      this->evict(iter);
+    }
+  }
+}
@@ -14,6 +14,7 @@ etcd::Response::Response(const etcd::Response& response) {
   this->_prev_value = response._prev_value;
   this->_values = response._values;
   this->_keys = response._keys;
+  this->_count = response._count;
   this->_compact_revision = response._compact_revision;
   this->_lock_key = response._lock_key;
   this->_name = response._name;
@@ -26,6 +27,7 @@ etcd::Response::Response(const etcd::Response& response) {
 
   this->_leases = response._leases;
   this->_members = response._members;
+  this->_responses = response._responses;
 }
 
 etcd::Response::Response(const etcdv3::V3Response& reply,
@@ -45,6 +47,7 @@ etcd::Response::Response(const etcdv3::V3Response& reply,
     _value = Value(reply.get_value());
   }
   _prev_value = Value(reply.get_prev_value());
+  _count = reply.get_count();
 
   _compact_revision = reply.get_compact_revision();
   _watch_id = reply.get_watch_id();
@@ -67,6 +70,15 @@ etcd::Response::Response(const etcdv3::V3Response& reply,
   this->_leases = reply.get_leases();
   // member list
   this->_members = reply.get_members();
+
+  // txn operations
+  for (auto const& op_reply : reply.get_responses()) {
+    _responses.emplace_back(Response(op_reply, duration));
+    if (_responses.back()._index == 0) {
+      // the revision is only available in the header of the txn
+      _responses.back()._index = _index;
+    }
+  }
 }
 
 etcd::Response::Response(int error_code, std::string const& error_message)
@@ -109,6 +121,8 @@ etcd::Keys const& etcd::Response::keys() const { return _keys; }
 
 std::string const& etcd::Response::key(int index) const { return _keys[index]; }
 
+int64_t etcd::Response::count() const { return _count; }
+
 int64_t etcd::Response::compact_revision() const { return _compact_revision; }
 
 int64_t etcd::Response::watch_id() const { return _watch_id; }
@@ -138,3 +152,7 @@ std::vector<int64_t> const& etcd::Response::leases() const {
 std::vector<etcdv3::Member> const& etcd::Response::members() const {
   return this->_members;
 }
+
+std::vector<etcd::Response> const& etcd::Response::responses() const {
+  return this->_responses;
+}
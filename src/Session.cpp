@@ -0,0 +1,108 @@
+#include "etcd/Session.hpp"
+#include "etcd/v3/Action.hpp"
+#include "etcd/v3/AsyncGRPC.hpp"
+#include "etcd/v3/Transaction.hpp"
+
+const size_t etcd::Session::DEFAULT_MAX_RETRIES;
+
+etcd::Session::Session(SyncClient& client, size_t const max_retries)
+    : client(client), max_retries(max_retries) {}
+
+void etcd::Session::observe(Response const& resp) {
+  int64_t const revision = resp.index();
+  int64_t current = session_revision.load();
+  while (current < revision &&
+         !session_revision.compare_exchange_weak(current, revision)) {
+  }
+}
+
+etcd::Response etcd::Session::set(std::string const& key,
+                                  std::string const& value,
+                                  const int64_t leaseId) {
+  return this->written(client.set(key, value, leaseId));
+}
+
+etcd::Response etcd::Session::add(std::string const& key,
+                                  std::string const& value,
+                                  const int64_t leaseId) {
+  return this->written(client.add(key, value, leaseId));
+}
+
+etcd::Response etcd::Session::put(std::string const& key,
+                                  std::string const& value,
+                                  const int64_t leaseId) {
+  return this->written(client.put(key, value, leaseId));
+}
+
+etcd::Response etcd::Session::modify(std::string const& key,
+                                     std::string const& value,
+                                     const int64_t leaseId) {
+  return this->written(client.modify(key, value, leaseId));
+}
+
+etcd::Response etcd::Session::rm(std::string const& key) {
+  return this->written(client.rm(key));
+}
+
+etcd::Response etcd::Session::rmdir(std::string const& key,
+                                    bool recursive) {
+  return this->written(client.rmdir(key, recursive));
+}
+
+etcd::Response etcd::Session::rmdir(std::string const& key,
+                                    std::string const& range_end) {
+  return this->written(client.rmdir(key, range_end));
+}
+
+etcd::Response etcd::Session::txn(etcdv3::Transaction const& txn) {
+  return this->written(client.txn(txn));
+}
+
+etcd::Response etcd::Session::get(std::string const& key) {
+  return this->read(key, "", false);
+}
+
+etcd::Response etcd::Session::ls(std::string const& prefix) {
+  return this->read(prefix, "", true);
+}
+
+etcd::Response etcd::Session::ls(std::string const& key,
+                                 std::string const& range_end) {
+  return this->read(key, range_end, false);
+}
+
+etcd::Response etcd::Session::written(Response const& resp) {
+  this->observe(resp);
+  return resp;
+}
+
+etcd::Response etcd::Session::read(std::string const& key,
+                                   std::string const& range_end,
+                                   bool const with_prefix) {
+  auto call = [&](bool const serializable) {
+    etcdv3::ActionParameters params;
+    params.key.assign(key);
+    params.range_end.assign(range_end);
+    params.withPrefix = with_prefix;
+    params.serializable = serializable;
+    return Response::create(this->client.range_internal(params));
+  };
+
+  int64_t const revision = this->revision();
+  for (size_t attempt = 0; attempt <= max_retries; ++attempt) {
+    if (attempt > 0) {
+      retry_count += 1;
+    }
+    // a failed read has no revision, and is retried as well
+    Response resp = call(true);
+    if (resp.index() > 0 && resp.index() >= revision) {
+      this->observe(resp);
+      return resp;
+    }
+  }
+
+  fallback_count += 1;
+  Response resp = call(false);
+  this->observe(resp);
+  return resp;
+}
@@ -0,0 +1,80 @@
+#include "etcd/Snapshot.hpp"
+#include "etcd/v3/Action.hpp"
+#include "etcd/v3/AsyncGRPC.hpp"
+
+etcd::Snapshot::Snapshot(SyncClient& client, int64_t const revision)
+    : client(client), pinned_revision(revision > 0 ? revision : 0) {}
+
+etcd::Response etcd::Snapshot::get(std::string const& key) {
+  return this->read([this, &key](int64_t const revision) {
+    return this->client.get_internal(key, revision,
+                                     ReadConsistency::LINEARIZABLE);
+  });
+}
+
+std::vector<etcd::Response> etcd::Snapshot::get(
+    std::vector<std::string> const& keys) {
+  Response head = this->pin_head();
+  if (!head.is_ok()) {
+    return std::vector<Response>(keys.size(), head);
+  }
+  int64_t const revision = this->revision();
+
+  // all requests are in flight before waiting for the first one
+  std::vector<std::shared_ptr<etcdv3::AsyncRangeAction>> calls;
+  calls.reserve(keys.size());
+  for (auto const& key : keys) {
+    calls.emplace_back(
+        client.get_internal(key, revision, ReadConsistency::LINEARIZABLE));
+  }
+  std::vector<Response> responses;
+  responses.reserve(keys.size());
+  for (auto& call : calls) {
+    responses.emplace_back(Response::create(std::move(call)));
+  }
+  return responses;
+}
+
+etcd::Response etcd::Snapshot::ls(std::string const& prefix) {
+  return this->read([this, &prefix](int64_t const revision) {
+    return this->client.ls_internal(prefix, 0, false, revision,
+                                    ReadConsistency::LINEARIZABLE);
+  });
+}
+
+etcd::Response etcd::Snapshot::ls(std::string const& key,
+                                  std::string const& range_end) {
+  return this->read([this, &key, &range_end](int64_t const revision) {
+    return this->client.ls_internal(key, range_end, 0, false, revision,
+                                    ReadConsistency::LINEARIZABLE);
+  });
+}
+
+etcd::Response etcd::Snapshot::read(
+    std::function<std::shared_ptr<etcdv3::AsyncRangeAction>(int64_t)> const&
+        call) {
+  int64_t const revision = this->revision();
+  Response resp = Response::create(call(revision));
+  if (revision == 0 && resp.index() > 0 && !this->pin(resp.index())) {
+    // another read has pinned a different revision in the meantime
+    resp = Response::create(call(this->revision()));
+  }
+  return resp;
+}
+
+bool etcd::Snapshot::pin(int64_t const revision) {
+  int64_t expected = 0;
+  return pinned_revision.compare_exchange_strong(expected, revision) ||
+         expected == revision;
+}
+
+etcd::Response etcd::Snapshot::pin_head() {
+  if (this->revision() > 0) {
+    return Response();
+  }
+  Response head = client.head();
+  if (head.is_ok()) {
+    this->pin(head.index());
+  }
+  return head;
+}
@@ -25,7 +25,11 @@
 #include <sys/socket.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <limits>
@@ -299,6 +303,29 @@ static std::shared_ptr<grpc::Channel> create_grpc_channel(
   }
 }
 
+// issues the calls with at most `max_inflight` outstanding ones, and collects
+// the responses in order.
+template <typename T>
+static std::vector<Response> pipeline(
+    size_t const count, size_t const max_inflight,
+    std::function<std::shared_ptr<T>(size_t)> const& make_call) {
+  std::vector<Response> responses;
+  responses.reserve(count);
+  std::deque<std::shared_ptr<T>> inflight;
+  for (size_t index = 0; index < count; ++index) {
+    if (inflight.size() >= std::max(max_inflight, static_cast<size_t>(1))) {
+      responses.emplace_back(Response::create(inflight.front()));
+      inflight.pop_front();
+    }
+    inflight.emplace_back(make_call(index));
+  }
+  while (!inflight.empty()) {
+    responses.emplace_back(Response::create(inflight.front()));
+    inflight.pop_front();
+  }
+  return responses;
+}
+
 }  // namespace detail
 }  // namespace etcd
 
@@ -571,6 +598,7 @@ etcd::SyncClient* etcd::SyncClient::WithSSL(
 }
 
 etcd::SyncClient::~SyncClient() {
+  election_loop.reset();
   stubs.reset();
   channel.reset();
 }
@@ -588,20 +616,43 @@ std::shared_ptr<etcdv3::AsyncHeadAction> etcd::SyncClient::head_internal() {
 }
 
 etcd::Response etcd::SyncClient::get(std::string const& key) {
-  return Response::create(this->get_internal(key));
+  return this->coalesced_read(read_signature("get", key, "", 0, 0),
+                              [&]() { return this->get_internal(key); });
 }
 
 etcd::Response etcd::SyncClient::get(std::string const& key,
                                      const int64_t revision) {
-  return Response::create(this->get_internal(key, revision));
+  return this->coalesced_read(
+      read_signature("get", key, "", 0, revision),
+      [&]() { return this->get_internal(key, revision); });
+}
+
+etcd::Response etcd::SyncClient::get(std::string const& key,
+                                     ReadConsistency consistency) {
+  return this->coalesced_read(
+      read_signature("get", key, "", 0, 0), consistency,
+      [&]() { return this->get_internal(key, 0, consistency); });
+}
+
+etcd::Response etcd::SyncClient::get(std::string const& key,
+                                     RangeOptions const& options) {
+  return this->coalesced_read(
+      read_signature("get", key, "", options),
+      [&]() { return this->range_internal(key, "", false, false, options); });
 }
 
 std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::get_internal(
     std::string const& key, int64_t revision) {
+  return this->get_internal(key, revision, this->read_consistency.load());
+}
+
+std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::get_internal(
+    std::string const& key, int64_t revision, ReadConsistency consistency) {
   etcdv3::ActionParameters params;
   params.key.assign(key);
   params.revision = revision;
   params.withPrefix = false;
+  params.serializable = consistency == ReadConsistency::SERIALIZABLE;
   params.auth_token.assign(this->token_authenticator->renew_if_expired());
   params.grpc_timeout = this->grpc_timeout;
   params.kv_stub = stubs->kvServiceStub.get();
@@ -774,12 +825,77 @@ etcd::Response etcd::SyncClient::rmdir(std::string const& key,
   return Response::create(this->rmdir_internal(key, range_end));
 }
 
+etcd::Response etcd::SyncClient::rmdir_chunked(std::string const& key,
+                                               size_t const chunk_size,
+                                               bool const prev_kv,
+                                               DeleteProgress const& progress) {
+  return this->rmdir_chunked(
+      key, key.empty() ? etcdv3::NUL : etcdv3::detail::string_plus_one(key),
+      chunk_size, prev_kv, progress);
+}
+
+etcd::Response etcd::SyncClient::rmdir_chunked(std::string const& key,
+                                               std::string const& range_end,
+                                               size_t const chunk_size,
+                                               bool const prev_kv,
+                                               DeleteProgress const& progress) {
+  size_t const limit = std::max(chunk_size, static_cast<size_t>(1));
+  std::string const start = key.empty() ? etcdv3::NUL : key;
+
+  Response result;
+  result._action = etcdv3::DELETE_ACTION;
+  int64_t deleted = 0;
+  while (true) {
+    // the deleted keys are gone, thus always starts from the beginning
+    Response page =
+        Response::create(this->ls_internal(start, range_end, limit, true, 0));
+    if (!page.is_ok()) {
+      page._count = deleted;
+      return page;
+    }
+    if (page.keys().empty()) {
+      break;
+    }
+
+    Response resp = Response::create(this->rmdir_internal(
+        page.keys().front(), page.keys().back() + etcdv3::NUL, prev_kv));
+    if (!resp.is_ok() && resp.error_code() != etcdv3::ERROR_KEY_NOT_FOUND) {
+      resp._count = deleted;
+      return resp;
+    }
+    deleted += resp._count;
+    result._index = resp._index;
+    for (auto const& value : resp._values) {
+      result._values.emplace_back(value);
+      result._keys.emplace_back(value.key());
+    }
+    if (progress) {
+      progress(deleted);
+    }
+    if (page.keys().size() < limit) {
+      break;
+    }
+  }
+
+  result._count = deleted;
+  if (!result._values.empty()) {
+    result._value = result._values.front();
+    result._prev_value = result._values.front();
+  }
+  if (deleted == 0) {
+    result._error_code = etcdv3::ERROR_KEY_NOT_FOUND;
+    result._error_message = "etcd-cpp-apiv3: key not found";
+  }
+  return result;
+}
+
 std::shared_ptr<etcdv3::AsyncDeleteAction> etcd::SyncClient::rmdir_internal(
-    std::string const& key, std::string const& range_end) {
+    std::string const& key, std::string const& range_end, bool const prev_kv) {
   etcdv3::ActionParameters params;
   params.key.assign(key);
   params.range_end.assign(range_end);
   params.withPrefix = false;
+  params.prev_kv = prev_kv;
   params.auth_token.assign(this->token_authenticator->renew_if_expired());
   params.grpc_timeout = this->grpc_timeout;
   params.kv_stub = stubs->kvServiceStub.get();
@@ -787,81 +903,208 @@ std::shared_ptr<etcdv3::AsyncDeleteAction> etcd::SyncClient::rmdir_internal(
 }
 
 etcd::Response etcd::SyncClient::ls(std::string const& key) {
-  return Response::create(this->ls_internal(key, 0 /* default: no limit */));
+  return this->coalesced_read(
+      read_signature("ls", key, "", 0, 0),
+      [&]() { return this->ls_internal(key, 0 /* default: no limit */); });
 }
 
 etcd::Response etcd::SyncClient::ls(std::string const& key,
                                     size_t const limit) {
-  return Response::create(this->ls_internal(key, limit));
+  return this->coalesced_read(read_signature("ls", key, "", limit, 0),
+                              [&]() { return this->ls_internal(key, limit); });
 }
 
 etcd::Response etcd::SyncClient::ls(std::string const& key, size_t const limit,
                                     int64_t revision) {
-  return Response::create(this->ls_internal(key, limit, false, revision));
+  return this->coalesced_read(
+      read_signature("ls", key, "", limit, revision),
+      [&]() { return this->ls_internal(key, limit, false, revision); });
 }
 
 etcd::Response etcd::SyncClient::ls(std::string const& key,
                                     std::string const& range_end) {
-  return Response::create(
-      this->ls_internal(key, range_end, 0 /* default: no limit */));
+  return this->coalesced_read(
+      read_signature("range", key, range_end, 0, 0), [&]() {
+        return this->ls_internal(key, range_end, 0 /* default: no limit */);
+      });
 }
 
 etcd::Response etcd::SyncClient::ls(std::string const& key,
                                     std::string const& range_end,
                                     size_t const limit) {
-  return Response::create(this->ls_internal(key, range_end, limit));
+  return this->coalesced_read(
+      read_signature("range", key, range_end, limit, 0),
+      [&]() { return this->ls_internal(key, range_end, limit); });
 }
 
 etcd::Response etcd::SyncClient::ls(std::string const& key,
                                     std::string const& range_end,
                                     size_t const limit, int64_t revision) {
-  return Response::create(
-      this->ls_internal(key, range_end, limit, false, revision));
+  return this->coalesced_read(
+      read_signature("range", key, range_end, limit, revision), [&]() {
+        return this->ls_internal(key, range_end, limit, false, revision);
+      });
 }
 
 etcd::Response etcd::SyncClient::keys(std::string const& key) {
-  return Response::create(
-      this->ls_internal(key, 0 /* default: no limit */, true));
+  return this->coalesced_read(
+      read_signature("keys", key, "", 0, 0), [&]() {
+        return this->ls_internal(key, 0 /* default: no limit */, true);
+      });
 }
 
 etcd::Response etcd::SyncClient::keys(std::string const& key,
                                       size_t const limit) {
-  return Response::create(this->ls_internal(key, limit, true));
+  return this->coalesced_read(
+      read_signature("keys", key, "", limit, 0),
+      [&]() { return this->ls_internal(key, limit, true); });
 }
 
 etcd::Response etcd::SyncClient::keys(std::string const& key,
                                       size_t const limit, int64_t revision) {
-  return Response::create(this->ls_internal(key, limit, true, revision));
+  return this->coalesced_read(
+      read_signature("keys", key, "", limit, revision),
+      [&]() { return this->ls_internal(key, limit, true, revision); });
 }
 
 etcd::Response etcd::SyncClient::keys(std::string const& key,
                                       std::string const& range_end) {
-  return Response::create(
-      this->ls_internal(key, range_end, 0 /* default: no limit */, true));
+  return this->coalesced_read(
+      read_signature("range-keys", key, range_end, 0, 0), [&]() {
+        return this->ls_internal(key, range_end, 0 /* default: no limit */,
+                                 true);
+      });
 }
 
 etcd::Response etcd::SyncClient::keys(std::string const& key,
                                       std::string const& range_end,
                                       size_t const limit) {
-  return Response::create(this->ls_internal(key, range_end, limit, true));
+  return this->coalesced_read(
+      read_signature("range-keys", key, range_end, limit, 0),
+      [&]() { return this->ls_internal(key, range_end, limit, true); });
 }
 
 etcd::Response etcd::SyncClient::keys(std::string const& key,
                                       std::string const& range_end,
                                       size_t const limit, int64_t revision) {
-  return Response::create(
-      this->ls_internal(key, range_end, limit, true, revision));
+  return this->coalesced_read(
+      read_signature("range-keys", key, range_end, limit, revision),
+      [&]() {
+        return this->ls_internal(key, range_end, limit, true, revision);
+      });
+}
+
+etcd::Response etcd::SyncClient::ls(std::string const& key,
+                                    RangeOptions const& options) {
+  return this->coalesced_read(
+      read_signature("ls", key, "", options),
+      [&]() { return this->range_internal(key, "", true, false, options); });
+}
+
+etcd::Response etcd::SyncClient::ls(std::string const& key,
+                                    std::string const& range_end,
+                                    RangeOptions const& options) {
+  return this->coalesced_read(
+      read_signature("range", key, range_end, options), [&]() {
+        return this->range_internal(key, range_end, false, false, options);
+      });
+}
+
+etcd::Response etcd::SyncClient::keys(std::string const& key,
+                                      RangeOptions const& options) {
+  return this->coalesced_read(
+      read_signature("keys", key, "", options),
+      [&]() { return this->range_internal(key, "", true, true, options); });
+}
+
+etcd::Response etcd::SyncClient::keys(std::string const& key,
+                                      std::string const& range_end,
+                                      RangeOptions const& options) {
+  return this->coalesced_read(
+      read_signature("range-keys", key, range_end, options), [&]() {
+        return this->range_internal(key, range_end, false, true, options);
+      });
+}
+
+etcd::Response etcd::SyncClient::ls(std::string const& key,
+                                    ReadConsistency consistency) {
+  return this->coalesced_read(
+      read_signature("ls", key, "", 0, 0), consistency,
+      [&]() { return this->ls_internal(key, 0, false, 0, consistency); });
+}
+
+etcd::Response etcd::SyncClient::ls(std::string const& key,
+                                    std::string const& range_end,
+                                    ReadConsistency consistency) {
+  return this->coalesced_read(
+      read_signature("range", key, range_end, 0, 0), consistency, [&]() {
+        return this->ls_internal(key, range_end, 0, false, 0, consistency);
+      });
+}
+
+etcd::Response etcd::SyncClient::keys(std::string const& key,
+                                      ReadConsistency consistency) {
+  return this->coalesced_read(
+      read_signature("keys", key, "", 0, 0), consistency,
+      [&]() { return this->ls_internal(key, 0, true, 0, consistency); });
+}
+
+etcd::Response etcd::SyncClient::keys(std::string const& key,
+                                      std::string const& range_end,
+                                      ReadConsistency consistency) {
+  return this->coalesced_read(
+      read_signature("range-keys", key, range_end, 0, 0), consistency, [&]() {
+        return this->ls_internal(key, range_end, 0, true, 0, consistency);
+      });
+}
+
+etcd::Response etcd::SyncClient::count(std::string const& key) {
+  return this->coalesced_read(
+      read_signature("count", key, "", 0, 0),
+      [&]() { return this->count_internal(key, "", true); });
+}
+
+etcd::Response etcd::SyncClient::count(std::string const& key,
+                                       std::string const& range_end) {
+  return this->coalesced_read(
+      read_signature("range-count", key, range_end, 0, 0),
+      [&]() { return this->count_internal(key, range_end, false); });
+}
+
+etcd::Response etcd::SyncClient::count(std::string const& key,
+                                       ReadConsistency consistency) {
+  return this->coalesced_read(
+      read_signature("count", key, "", 0, 0), consistency,
+      [&]() { return this->count_internal(key, "", true, consistency); });
+}
+
+etcd::Response etcd::SyncClient::count(std::string const& key,
+                                       std::string const& range_end,
+                                       ReadConsistency consistency) {
+  return this->coalesced_read(
+      read_signature("range-count", key, range_end, 0, 0), consistency,
+      [&]() {
+        return this->count_internal(key, range_end, false, consistency);
+      });
 }
 
 std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::ls_internal(
     std::string const& key, size_t const limit, bool const keys_only,
     int64_t revision) {
+  return this->ls_internal(key, limit, keys_only, revision,
+                           this->read_consistency.load());
+}
+
+std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::ls_internal(
+    std::string const& key, size_t const limit, bool const keys_only,
+    int64_t revision, ReadConsistency consistency) {
   etcdv3::ActionParameters params;
   params.key.assign(key);
   params.keys_only = keys_only;
   params.withPrefix = true;
   params.limit = limit;
   params.revision = revision;
+  params.serializable = consistency == ReadConsistency::SERIALIZABLE;
   params.auth_token.assign(this->token_authenticator->renew_if_expired());
   params.grpc_timeout = this->grpc_timeout;
   params.kv_stub = stubs->kvServiceStub.get();
@@ -871,6 +1114,13 @@ std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::ls_internal(
 std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::ls_internal(
     std::string const& key, std::string const& range_end, size_t const limit,
     bool const keys_only, int64_t revision) {
+  return this->ls_internal(key, range_end, limit, keys_only, revision,
+                           this->read_consistency.load());
+}
+
+std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::ls_internal(
+    std::string const& key, std::string const& range_end, size_t const limit,
+    bool const keys_only, int64_t revision, ReadConsistency consistency) {
   etcdv3::ActionParameters params;
   params.key.assign(key);
   params.range_end.assign(range_end);
@@ -878,12 +1128,86 @@ std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::ls_internal(
   params.withPrefix = false;
   params.limit = limit;
   params.revision = revision;
+  params.serializable = consistency == ReadConsistency::SERIALIZABLE;
+  params.auth_token.assign(this->token_authenticator->renew_if_expired());
+  params.grpc_timeout = this->grpc_timeout;
+  params.kv_stub = stubs->kvServiceStub.get();
+  return std::make_shared<etcdv3::AsyncRangeAction>(std::move(params));
+}
+
+std::shared_ptr<etcdv3::AsyncRangeAction>
+etcd::SyncClient::ls_by_create_internal(std::string const& prefix,
+                                        bool const first, bool const keys_only,
+                                        int64_t max_create_revision,
+                                        size_t const limit) {
+  etcdv3::ActionParameters params;
+  params.key.assign(prefix);
+  params.keys_only = keys_only;
+  params.withPrefix = true;
+  params.limit = limit;
+  params.sort_target = etcdserverpb::RangeRequest::CREATE;
+  params.sort_order = first ? etcdserverpb::RangeRequest::ASCEND
+                            : etcdserverpb::RangeRequest::DESCEND;
+  // the recipes wait on their predecessors, always linearizable
+  params.max_create_revision = max_create_revision;
+  params.auth_token.assign(this->token_authenticator->renew_if_expired());
+  params.grpc_timeout = this->grpc_timeout;
+  params.kv_stub = stubs->kvServiceStub.get();
+  return std::make_shared<etcdv3::AsyncRangeAction>(std::move(params));
+}
+
+std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::range_internal(
+    etcdv3::ActionParameters& params) {
   params.auth_token.assign(this->token_authenticator->renew_if_expired());
   params.grpc_timeout = this->grpc_timeout;
   params.kv_stub = stubs->kvServiceStub.get();
   return std::make_shared<etcdv3::AsyncRangeAction>(std::move(params));
 }
 
+std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::range_internal(
+    std::string const& key, std::string const& range_end,
+    bool const with_prefix, bool const keys_only,
+    RangeOptions const& options) {
+  etcdv3::ActionParameters params;
+  params.key.assign(key);
+  params.range_end.assign(range_end);
+  params.withPrefix = with_prefix;
+  params.keys_only = keys_only;
+  params.limit = options.limit;
+  params.revision = options.revision;
+  // the enumerators have the same values as the ones in `RangeRequest`
+  params.sort_order = static_cast<etcdserverpb::RangeRequest::SortOrder>(
+      options.sort_order);
+  params.sort_target = static_cast<etcdserverpb::RangeRequest::SortTarget>(
+      options.sort_target);
+  params.min_mod_revision = options.min_mod_revision;
+  params.max_mod_revision = options.max_mod_revision;
+  params.min_create_revision = options.min_create_revision;
+  params.max_create_revision = options.max_create_revision;
+  params.serializable =
+      this->read_consistency.load() == ReadConsistency::SERIALIZABLE;
+  return this->range_internal(params);
+}
+
+std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::count_internal(
+    std::string const& key, std::string const& range_end,
+    bool const with_prefix) {
+  return this->count_internal(key, range_end, with_prefix,
+                              this->read_consistency.load());
+}
+
+std::shared_ptr<etcdv3::AsyncRangeAction> etcd::SyncClient::count_internal(
+    std::string const& key, std::string const& range_end,
+    bool const with_prefix, ReadConsistency consistency) {
+  etcdv3::ActionParameters params;
+  params.key.assign(key);
+  params.range_end.assign(range_end);
+  params.withPrefix = with_prefix;
+  params.count_only = true;
+  params.serializable = consistency == ReadConsistency::SERIALIZABLE;
+  return this->range_internal(params);
+}
+
 etcd::Response etcd::SyncClient::watch(std::string const& key, bool recursive) {
   return Response::create(
       this->watch_internal(key, 0 /* from current location */, recursive));
@@ -941,14 +1265,18 @@ etcd::Response etcd::SyncClient::leasegrant(int ttl) {
   // immediately after the lease is granted by the server.
   //
   // otherwise when we get the response, the lease might already has expired.
-  return Response::create<etcdv3::AsyncLeaseGrantAction>([this, ttl]() {
-    etcdv3::ActionParameters params;
-    params.auth_token.assign(this->token_authenticator->renew_if_expired());
-    params.grpc_timeout = this->grpc_timeout;
-    params.lease_stub = stubs->leaseServiceStub.get();
-    params.ttl = ttl;
-    return std::make_shared<etcdv3::AsyncLeaseGrantAction>(std::move(params));
-  });
+  return Response::create<etcdv3::AsyncLeaseGrantAction>(
+      [this, ttl]() { return this->leasegrant_internal(ttl); });
+}
+
+std::shared_ptr<etcdv3::AsyncLeaseGrantAction>
+etcd::SyncClient::leasegrant_internal(int ttl) {
+  etcdv3::ActionParameters params;
+  params.auth_token.assign(this->token_authenticator->renew_if_expired());
+  params.grpc_timeout = this->grpc_timeout;
+  params.lease_stub = stubs->leaseServiceStub.get();
+  params.ttl = ttl;
+  return std::make_shared<etcdv3::AsyncLeaseGrantAction>(std::move(params));
 }
 
 std::shared_ptr<etcd::KeepAlive> etcd::SyncClient::leasekeepalive(int ttl) {
@@ -1024,6 +1352,38 @@ etcd::Response etcd::SyncClient::add_member(std::string const& peer_urls,
   return Response::create(this->add_member_internal(peer_urls, is_learner));
 }
 
+std::vector<etcd::Response> etcd::SyncClient::leasegrant_batch(
+    std::vector<int> const& ttls, size_t const max_inflight) {
+  return detail::pipeline<etcdv3::AsyncLeaseGrantAction>(
+      ttls.size(), max_inflight,
+      [&](size_t index) { return this->leasegrant_internal(ttls[index]); });
+}
+
+std::vector<etcd::Response> etcd::SyncClient::leaserevoke_batch(
+    std::vector<int64_t> const& lease_ids, size_t const max_inflight) {
+  return detail::pipeline<etcdv3::AsyncLeaseRevokeAction>(
+      lease_ids.size(), max_inflight, [&](size_t index) {
+        return this->leaserevoke_internal(lease_ids[index]);
+      });
+}
+
+std::vector<etcd::Response> etcd::SyncClient::leasetimetolive_batch(
+    std::vector<int64_t> const& lease_ids, size_t const max_inflight) {
+  return detail::pipeline<etcdv3::AsyncLeaseTimeToLiveAction>(
+      lease_ids.size(), max_inflight, [&](size_t index) {
+        return this->leasetimetolive_internal(lease_ids[index]);
+      });
+}
+
+std::vector<etcd::Response> etcd::SyncClient::leases_with_ttl(
+    size_t const max_inflight) {
+  Response resp = this->leases();
+  if (!resp.is_ok()) {
+    return std::vector<Response>{resp};
+  }
+  return this->leasetimetolive_batch(resp.leases(), max_inflight);
+}
+
 std::shared_ptr<etcdv3::AsyncAddMemberAction>
 etcd::SyncClient::add_member_internal(std::string const& peer_urls,
                                       bool is_learner) {
@@ -1181,6 +1541,48 @@ etcd::Response etcd::SyncClient::txn(etcdv3::Transaction const& txn) {
   return Response::create(this->txn_internal(txn));
 }
 
+std::vector<etcd::Response> etcd::SyncClient::get_many(
+    std::vector<std::string> const& keys, size_t const max_ops,
+    size_t const max_inflight) {
+  size_t const chunk_size = std::max(max_ops, static_cast<size_t>(1));
+  size_t const chunks = (keys.size() + chunk_size - 1) / chunk_size;
+
+  std::vector<Response> chunk_responses =
+      detail::pipeline<etcdv3::AsyncTxnAction>(
+          chunks, max_inflight, [&](size_t chunk) {
+            etcdv3::Transaction txn;
+            size_t end = std::min(keys.size(), (chunk + 1) * chunk_size);
+            for (size_t index = chunk * chunk_size; index < end; ++index) {
+              txn.add_success_range(keys[index]);
+            }
+            return this->txn_internal(txn);
+          });
+
+  std::vector<Response> responses;
+  responses.reserve(keys.size());
+  for (size_t chunk = 0; chunk < chunks; ++chunk) {
+    Response const& txn_resp = chunk_responses[chunk];
+    size_t begin = chunk * chunk_size;
+    size_t end = std::min(keys.size(), begin + chunk_size);
+    if (txn_resp.responses().size() != end - begin) {
+      // the transaction failed as a whole
+      for (size_t index = begin; index < end; ++index) {
+        responses.emplace_back(txn_resp);
+      }
+      continue;
+    }
+    for (auto const& resp : txn_resp.responses()) {
+      responses.emplace_back(resp);
+      if (resp.is_ok() && resp.values().empty()) {
+        // ranges in txn don't report missing keys
+        responses.back()._error_code = ERROR_KEY_NOT_FOUND;
+        responses.back()._error_message = "etcd-cpp-apiv3: key not found";
+      }
+    }
+  }
+  return responses;
+}
+
 std::shared_ptr<etcdv3::AsyncTxnAction> etcd::SyncClient::txn_internal(
     etcdv3::Transaction const& txn) {
   etcdv3::ActionParameters params;
@@ -1282,6 +1684,135 @@ std::shared_ptr<etcdv3::AsyncResignAction> etcd::SyncClient::resign_internal(
   return std::make_shared<etcdv3::AsyncResignAction>(std::move(params));
 }
 
+struct etcd::SyncClient::ReadFlight {
+  std::string signature;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done = false;
+  Response response;
+  // the asynchronous reads that have joined the flight
+  std::vector<std::function<void(Response const&)>> callbacks;
+};
+
+std::string etcd::SyncClient::read_signature(char const* op,
+                                             std::string const& key,
+                                             std::string const& range_end,
+                                             size_t const limit,
+                                             int64_t const revision) {
+  std::string signature(op);
+  signature.push_back('\0');
+  signature.append(key);
+  signature.push_back('\0');
+  signature.append(range_end);
+  signature.push_back('\0');
+  signature.append(std::to_string(limit));
+  signature.push_back('\0');
+  signature.append(std::to_string(revision));
+  return signature;
+}
+
+std::string etcd::SyncClient::read_signature(char const* op,
+                                             std::string const& key,
+                                             std::string const& range_end,
+                                             RangeOptions const& options) {
+  std::string signature = read_signature(op, key, range_end, options.limit,
+                                         options.revision);
+  for (int64_t field :
+       {static_cast<int64_t>(options.sort_order),
+        static_cast<int64_t>(options.sort_target), options.min_mod_revision,
+        options.max_mod_revision, options.min_create_revision,
+        options.max_create_revision}) {
+    signature.push_back('\0');
+    signature.append(std::to_string(field));
+  }
+  return signature;
+}
+
+std::shared_ptr<etcd::SyncClient::ReadFlight> etcd::SyncClient::board_read(
+    std::string const& signature_without_consistency,
+    ReadConsistency consistency, bool& leader) {
+  // a linearizable read must not share the response of a serializable one
+  std::string signature(signature_without_consistency);
+  signature.push_back('\0');
+  signature.append(consistency == ReadConsistency::SERIALIZABLE ? "s" : "l");
+
+  std::lock_guard<std::mutex> scope_lock(mutex_for_read_flights);
+  auto iter = read_flights.find(signature);
+  if (iter != read_flights.end()) {
+    leader = false;
+    coalesced_read_hits += 1;
+    return iter->second;
+  }
+  auto flight = std::make_shared<ReadFlight>();
+  flight->signature = signature;
+  read_flights.emplace(signature, flight);
+  leader = true;
+  return flight;
+}
+
+void etcd::SyncClient::land_read(std::shared_ptr<ReadFlight> const& flight,
+                                 Response const& response) {
+  {
+    // later reads issue a new RPC
+    std::lock_guard<std::mutex> scope_lock(mutex_for_read_flights);
+    read_flights.erase(flight->signature);
+  }
+  std::vector<std::function<void(Response const&)>> callbacks;
+  {
+    std::lock_guard<std::mutex> flight_lock(flight->mutex);
+    flight->response = response;
+    flight->done = true;
+    callbacks.swap(flight->callbacks);
+  }
+  flight->cv.notify_all();
+  for (auto const& callback : callbacks) {
+    callback(response);
+  }
+}
+
+void etcd::SyncClient::on_landed(
+    std::shared_ptr<ReadFlight> const& flight,
+    std::function<void(Response const&)> const& callback) {
+  {
+    std::lock_guard<std::mutex> flight_lock(flight->mutex);
+    if (!flight->done) {
+      flight->callbacks.emplace_back(callback);
+      return;
+    }
+  }
+  callback(flight->response);
+}
+
+etcd::Response etcd::SyncClient::coalesced_read(
+    std::string const& signature,
+    std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+        make_call) {
+  return this->coalesced_read(signature, this->read_consistency.load(),
+                              make_call);
+}
+
+etcd::Response etcd::SyncClient::coalesced_read(
+    std::string const& signature, ReadConsistency consistency,
+    std::function<std::shared_ptr<etcdv3::AsyncRangeAction>()> const&
+        make_call) {
+  if (!this->coalesce_reads.load()) {
+    return Response::create(make_call());
+  }
+
+  bool leader = false;
+  std::shared_ptr<ReadFlight> flight =
+      this->board_read(signature, consistency, leader);
+  if (!leader) {
+    std::unique_lock<std::mutex> flight_lock(flight->mutex);
+    flight->cv.wait(flight_lock, [&]() { return flight->done; });
+    return flight->response;
+  }
+
+  Response response = Response::create(make_call());
+  this->land_read(flight, response);
+  return response;
+}
+
 const std::string& etcd::SyncClient::current_auth_token() const {
   return this->token_authenticator->renew_if_expired();
 }
@@ -1290,13 +1821,6 @@ std::shared_ptr<grpc::Channel> etcd::SyncClient::grpc_channel() const {
   return this->channel;
 }
 
-etcd::SyncClient::Observer::~Observer() {
-  if (this->action != nullptr) {
-    this->action->CancelObserve();
-    this->action = nullptr;
-  }
-}
-
 etcd::Response etcd::SyncClient::Observer::WaitOnce() {
   if (this->action != nullptr) {
     return Response::create(this->action);
@@ -1304,3 +1828,283 @@ etcd::Response etcd::SyncClient::Observer::WaitOnce() {
     return Response{};
   }
 }
+
+struct etcd::SyncClient::ElectionCall {
+  enum class Kind { CAMPAIGN, OBSERVE };
+  enum Op { CREATE = 0, READ = 1, FINISH = 2 };
+  struct Tag {
+    ElectionCall* call;
+    Op op;
+  };
+
+  ElectionCall(Kind kind, std::function<void(Response)> const& callback,
+               Executor const& executor)
+      : kind(kind),
+        tags{{this, CREATE}, {this, READ}, {this, FINISH}},
+        callback(callback),
+        executor(executor),
+        start_timepoint(std::chrono::high_resolution_clock::now()),
+        done(false),
+        cancelled(false) {}
+
+  // returns false if the call has been finished
+  bool Proceed(Op op, bool ok) {
+    if (kind == Kind::CAMPAIGN) {
+      etcdv3::AsyncCampaignResponse resp;
+      resp.set_action(etcdv3::CAMPAIGN_ACTION);
+      if (!status.ok()) {
+        resp.set_error_code(status.error_code());
+        resp.set_error_message(status.error_message());
+      } else {
+        resp.ParseResponse(campaign_reply);
+      }
+      this->Deliver(resp);
+      this->Finish();
+      return false;
+    }
+
+    switch (op) {
+    case CREATE:
+    case READ: {
+      if (!ok) {
+        observe_reader->Finish(&status, &tags[FINISH]);
+        return true;
+      }
+      if (op == READ && !cancelled.load()) {
+        etcdv3::AsyncObserveResponse resp;
+        resp.set_action(etcdv3::OBSERVE_ACTION);
+        resp.ParseResponse(observe_reply);
+        this->Deliver(resp);
+      }
+      observe_reader->Read(&observe_reply, &tags[READ]);
+      return true;
+    }
+    case FINISH:
+    default: {
+      if (!cancelled.load()) {
+        // the stream is broken, tell the observer
+        etcdv3::AsyncObserveResponse resp;
+        resp.set_action(etcdv3::OBSERVE_ACTION);
+        if (status.ok()) {
+          resp.set_error_code(etcdv3::ERROR_GRPC_CANCELLED);
+          resp.set_error_message("etcd-cpp-apiv3: observing stream closed");
+        } else {
+          resp.set_error_code(status.error_code());
+          resp.set_error_message(status.error_message());
+        }
+        this->Deliver(resp);
+      }
+      this->Finish();
+      return false;
+    }
+    }
+  }
+
+  void Deliver(etcdv3::V3Response const& v3resp) {
+    Response resp(v3resp, detail::duration_till_now(start_timepoint));
+    if (callback == nullptr) {
+      return;
+    }
+    if (executor == nullptr) {
+      callback(resp);
+    } else {
+      std::function<void(Response)> callback = this->callback;
+      executor([callback, resp]() { callback(resp); });
+    }
+  }
+
+  void Finish() {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    done = true;
+    cv.notify_all();
+  }
+
+  void Cancel() {
+    cancelled.store(true);
+    context.TryCancel();
+    if (std::this_thread::get_id() == loop_thread_id) {
+      // inside the callback
+      return;
+    }
+    std::unique_lock<std::mutex> scope_lock(mutex);
+    cv.wait(scope_lock, [this]() { return done; });
+  }
+
+  bool Done() {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    return done;
+  }
+
+  Kind kind;
+  Tag tags[3];
+
+  grpc::ClientContext context;
+  grpc::Status status;
+  v3electionpb::CampaignResponse campaign_reply;
+  std::unique_ptr<
+      grpc::ClientAsyncResponseReader<v3electionpb::CampaignResponse>>
+      campaign_reader;
+  v3electionpb::LeaderResponse observe_reply;
+  std::unique_ptr<grpc::ClientAsyncReader<v3electionpb::LeaderResponse>>
+      observe_reader;
+
+  std::function<void(Response)> callback;
+  Executor executor;
+  std::chrono::high_resolution_clock::time_point start_timepoint;
+  std::thread::id loop_thread_id;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool done;
+  std::atomic_bool cancelled;
+};
+
+struct etcd::SyncClient::ElectionEventLoop {
+  ElectionEventLoop() { worker = std::thread([this]() { this->Run(); }); }
+
+  ~ElectionEventLoop() {
+    std::vector<std::shared_ptr<ElectionCall>> pending;
+    {
+      std::lock_guard<std::mutex> scope_lock(mutex);
+      for (auto const& item : calls) {
+        pending.emplace_back(item.second);
+      }
+    }
+    for (auto const& call : pending) {
+      call->cancelled.store(true);
+      call->context.TryCancel();
+    }
+    {
+      // the cancelled calls will be finished by the event loop
+      std::unique_lock<std::mutex> scope_lock(mutex);
+      cv.wait(scope_lock, [this]() { return calls.empty(); });
+    }
+    cq.Shutdown();
+    worker.join();
+  }
+
+  // the call must be registered before being started
+  void Register(std::shared_ptr<ElectionCall> const& call) {
+    call->loop_thread_id = worker.get_id();
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    calls[call.get()] = call;
+  }
+
+  void Run() {
+    void* got_tag = nullptr;
+    bool ok = false;
+    while (cq.Next(&got_tag, &ok)) {
+      auto tag = static_cast<ElectionCall::Tag*>(got_tag);
+      if (!tag->call->Proceed(tag->op, ok)) {
+        std::lock_guard<std::mutex> scope_lock(mutex);
+        calls.erase(tag->call);
+        cv.notify_all();
+      }
+    }
+  }
+
+  grpc::CompletionQueue cq;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::map<ElectionCall*, std::shared_ptr<ElectionCall>> calls;
+
+  std::thread worker;
+};
+
+void etcd::SyncClient::ElectionEventLoopDeleter::operator()(
+    etcd::SyncClient::ElectionEventLoop* loop) {
+  if (loop) {
+    delete loop;
+  }
+}
+
+etcd::SyncClient::ElectionEventLoop* etcd::SyncClient::election_event_loop() {
+  std::lock_guard<std::mutex> scope_lock(mutex_for_election_loop);
+  if (election_loop == nullptr) {
+    election_loop.reset(new ElectionEventLoop());
+  }
+  return election_loop.get();
+}
+
+std::unique_ptr<etcd::SyncClient::Campaigner> etcd::SyncClient::campaign(
+    std::string const& name, int64_t lease_id, std::string const& value,
+    std::function<void(Response)> callback, Executor const& executor) {
+  auto call = std::make_shared<ElectionCall>(ElectionCall::Kind::CAMPAIGN,
+                                             callback, executor);
+  std::string const& auth_token = this->token_authenticator->renew_if_expired();
+  if (!auth_token.empty()) {
+    call->context.AddMetadata("token", auth_token);
+  }
+  if (this->grpc_timeout != std::chrono::microseconds::zero()) {
+    call->context.set_deadline(std::chrono::system_clock::now() +
+                               this->grpc_timeout);
+  }
+
+  v3electionpb::CampaignRequest campaign_request;
+  campaign_request.set_name(name);
+  campaign_request.set_lease(lease_id);
+  campaign_request.set_value(value);
+
+  auto loop = this->election_event_loop();
+  loop->Register(call);
+  call->campaign_reader = stubs->electionServiceStub->AsyncCampaign(
+      &call->context, campaign_request, &loop->cq);
+  call->campaign_reader->Finish(&call->campaign_reply, &call->status,
+                                &call->tags[ElectionCall::FINISH]);
+
+  std::unique_ptr<Campaigner> campaigner(new Campaigner());
+  campaigner->call = call;
+  return campaigner;
+}
+
+std::unique_ptr<etcd::SyncClient::Observer> etcd::SyncClient::observe(
+    std::string const& name, std::function<void(Response)> callback,
+    Executor const& executor) {
+  auto call = std::make_shared<ElectionCall>(ElectionCall::Kind::OBSERVE,
+                                             callback, executor);
+  std::string const& auth_token = this->token_authenticator->renew_if_expired();
+  if (!auth_token.empty()) {
+    call->context.AddMetadata("token", auth_token);
+  }
+
+  v3electionpb::LeaderRequest leader_request;
+  leader_request.set_name(name);
+
+  auto loop = this->election_event_loop();
+  loop->Register(call);
+  // n.b.: prepare first, as the completion may be consumed by the event loop
+  // before `AsyncObserve()` returns.
+  call->observe_reader = stubs->electionServiceStub->PrepareAsyncObserve(
+      &call->context, leader_request, &loop->cq);
+  call->observe_reader->StartCall(&call->tags[ElectionCall::CREATE]);
+
+  std::unique_ptr<Observer> observer(new Observer());
+  observer->call = call;
+  return observer;
+}
+
+etcd::SyncClient::Campaigner::~Campaigner() { this->Cancel(); }
+
+void etcd::SyncClient::Campaigner::Cancel() {
+  if (this->call != nullptr && !this->call->Done()) {
+    this->call->Cancel();
+  }
+}
+
+bool etcd::SyncClient::Campaigner::Done() const {
+  return this->call == nullptr || this->call->Done();
+}
+
+etcd::SyncClient::Observer::~Observer() { this->Cancel(); }
+
+void etcd::SyncClient::Observer::Cancel() {
+  if (this->action != nullptr) {
+    this->action->CancelObserve();
+    this->action = nullptr;
+  }
+  if (this->call != nullptr) {
+    this->call->Cancel();
+    this->call = nullptr;
+  }
+}
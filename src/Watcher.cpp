@@ -37,7 +37,18 @@ etcd::Watcher::Watcher(SyncClient const& client, std::string const& key,
                        int64_t fromIndex,
                        std::function<void(Response)> callback,
                        std::function<void(bool)> wait_callback, bool recursive)
-    : wait_callback(wait_callback), fromIndex(fromIndex), recursive(recursive) {
+    : Watcher(client, key, fromIndex, callback, wait_callback, recursive,
+              false) {}
+
+etcd::Watcher::Watcher(SyncClient const& client, std::string const& key,
+                       int64_t fromIndex,
+                       std::function<void(Response)> callback,
+                       std::function<void(bool)> wait_callback, bool recursive,
+                       bool progress_notify)
+    : wait_callback(wait_callback),
+      fromIndex(fromIndex),
+      recursive(recursive),
+      progress_notify(progress_notify) {
   stubs.reset(new EtcdServerStubs{});
   stubs->watchServiceStub = Watch::NewStub(client.channel);
   doWatch(key, "", client.current_auth_token(), callback);
@@ -253,6 +264,8 @@ bool etcd::Watcher::Cancelled() const {
   return cancelled.load() || stubs->call->Cancelled();
 }
 
+void etcd::Watcher::RequestProgress() { stubs->call->RequestProgress(); }
+
 void etcd::Watcher::doWatch(std::string const& key,
                             std::string const& range_end,
                             std::string const& auth_token,
@@ -266,6 +279,7 @@ void etcd::Watcher::doWatch(std::string const& key,
     params.revision = fromIndex;
   }
   params.withPrefix = recursive;
+  params.progress_notify = progress_notify;
   params.watch_stub = stubs->watchServiceStub.get();
 
   stubs->call.reset(new etcdv3::AsyncWatchAction(std::move(params)));
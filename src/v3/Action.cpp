@@ -47,6 +47,15 @@ etcdv3::ActionParameters::ActionParameters() {
   ttl = 0;
   keys_only = false;
   count_only = false;
+  serializable = false;
+  prev_kv = true;
+  progress_notify = false;
+  sort_order = etcdserverpb::RangeRequest::NONE;
+  sort_target = etcdserverpb::RangeRequest::KEY;
+  min_mod_revision = 0;
+  max_mod_revision = 0;
+  min_create_revision = 0;
+  max_create_revision = 0;
   kv_stub = NULL;
   watch_stub = NULL;
   lease_stub = NULL;
@@ -74,6 +83,15 @@ void etcdv3::ActionParameters::dump(std::ostream& os) const {
   os << "  range_end:     " << range_end << std::endl;
   os << "  keys_only:     " << keys_only << std::endl;
   os << "  count_only:    " << count_only << std::endl;
+  os << "  serializable:  " << serializable << std::endl;
+  os << "  prev_kv:       " << prev_kv << std::endl;
+  os << "  progress_notify: " << progress_notify << std::endl;
+  os << "  sort_order:    " << sort_order << std::endl;
+  os << "  sort_target:   " << sort_target << std::endl;
+  os << "  min_mod_revision: " << min_mod_revision << std::endl;
+  os << "  max_mod_revision: " << max_mod_revision << std::endl;
+  os << "  min_create_revision: " << min_create_revision << std::endl;
+  os << "  max_create_revision: " << max_create_revision << std::endl;
   os << "  value:         " << value << std::endl;
   os << "  old_value:     " << old_value << std::endl;
   os << "  auth_token:    " << auth_token << std::endl;
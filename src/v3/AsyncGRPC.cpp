@@ -45,8 +45,10 @@ void etcdv3::AsyncCampaignResponse::ParseResponse(CampaignResponse& reply) {
 
 void etcdv3::AsyncDeleteResponse::ParseResponse(DeleteRangeResponse& resp) {
   index = resp.header().revision();
+  count = resp.deleted();
 
-  if (resp.prev_kvs_size() == 0) {
+  // the previous values are absent when `prev_kv` is not requested
+  if (resp.deleted() == 0) {
     error_code = etcdv3::ERROR_KEY_NOT_FOUND;
     error_message = "etcd-cpp-apiv3: key not found";
   } else {
@@ -181,6 +183,7 @@ void etcdv3::AsyncPutResponse::ParseResponse(PutResponse& resp) {
 void etcdv3::AsyncRangeResponse::ParseResponse(RangeResponse& resp,
                                                bool prefix) {
   index = resp.header().revision();
+  count = resp.count();
   if (resp.kvs_size() == 0 && !prefix) {
     error_code = etcdv3::ERROR_KEY_NOT_FOUND;
     error_message = "etcd-cpp-apiv3: key not found";
@@ -210,6 +213,8 @@ void etcdv3::AsyncTxnResponse::ParseResponse(TxnResponse& reply) {
     if (ResponseOp::ResponseCase::kResponseRange == resp.response_case()) {
       AsyncRangeResponse response;
       response.ParseResponse(*(resp.mutable_response_range()), true);
+      response.set_action(etcdv3::GET_ACTION);
+      responses.emplace_back(response);
 
       if (error_code == 0) {
         error_code = response.get_error_code();
@@ -229,6 +234,8 @@ void etcdv3::AsyncTxnResponse::ParseResponse(TxnResponse& reply) {
     } else if (ResponseOp::ResponseCase::kResponsePut == resp.response_case()) {
       AsyncPutResponse response;
       response.ParseResponse(*(resp.mutable_response_put()));
+      response.set_action(etcdv3::PUT_ACTION);
+      responses.emplace_back(response);
       if (error_code == 0) {
         error_code = response.get_error_code();
       }
@@ -248,6 +255,8 @@ void etcdv3::AsyncTxnResponse::ParseResponse(TxnResponse& reply) {
                resp.response_case()) {
       AsyncDeleteResponse response;
       response.ParseResponse(*(resp.mutable_response_delete_range()));
+      response.set_action(etcdv3::DELETE_ACTION);
+      responses.emplace_back(response);
 
       // Ignore "key not found" error for delete in txn, keep backwards
       // compatibility.
@@ -273,6 +282,8 @@ void etcdv3::AsyncTxnResponse::ParseResponse(TxnResponse& reply) {
     } else if (ResponseOp::ResponseCase::kResponseTxn == resp.response_case()) {
       AsyncTxnResponse response;
       response.ParseResponse(*(resp.mutable_response_txn()));
+      response.set_action(etcdv3::TXN_ACTION);
+      responses.emplace_back(response);
 
       if (error_code == 0) {
         error_code = response.get_error_code();
@@ -445,7 +456,7 @@ etcdv3::AsyncDeleteAction::AsyncDeleteAction(ActionParameters&& params)
   DeleteRangeRequest del_request;
   detail::make_request_with_ranges(del_request, parameters.key,
                                    parameters.range_end, parameters.withPrefix);
-  del_request.set_prev_kv(true /* fetch prev values */);
+  del_request.set_prev_kv(parameters.prev_kv /* fetch prev values */);
 
   response_reader =
       parameters.kv_stub->AsyncDeleteRange(&context, del_request, &cq_);
@@ -1042,13 +1053,29 @@ etcdv3::AsyncRangeAction::AsyncRangeAction(etcdv3::ActionParameters&& params)
   }
 
   get_request.set_limit(parameters.limit);
-  get_request.set_sort_order(
-      RangeRequest::SortOrder::RangeRequest_SortOrder_NONE);
+  get_request.set_sort_order(parameters.sort_order);
+  get_request.set_sort_target(parameters.sort_target);
+  if (parameters.min_mod_revision > 0) {
+    get_request.set_min_mod_revision(parameters.min_mod_revision);
+  }
+  if (parameters.max_mod_revision > 0) {
+    get_request.set_max_mod_revision(parameters.max_mod_revision);
+  }
+  if (parameters.min_create_revision > 0) {
+    get_request.set_min_create_revision(parameters.min_create_revision);
+  }
+  if (parameters.max_create_revision > 0) {
+    get_request.set_max_create_revision(parameters.max_create_revision);
+  }
 
   // set keys_only and count_only
   get_request.set_keys_only(params.keys_only);
   get_request.set_count_only(params.count_only);
 
+  // served by the local state of the member, without the read index round
+  // trip to the leader
+  get_request.set_serializable(parameters.serializable);
+
   response_reader = parameters.kv_stub->AsyncRange(&context, get_request, &cq_);
   response_reader->Finish(&reply, &status, (void*) this);
 }
@@ -1234,6 +1261,7 @@ etcdv3::AsyncWatchAction::AsyncWatchAction(etcdv3::ActionParameters&& params)
   detail::make_request_with_ranges(watch_create_req, parameters.key,
                                    parameters.range_end, parameters.withPrefix);
   watch_create_req.set_prev_kv(true);
+  watch_create_req.set_progress_notify(parameters.progress_notify);
   watch_create_req.set_start_revision(parameters.revision);
   watch_create_req.set_watch_id(this->watch_id);
 
@@ -1422,6 +1450,10 @@ void etcdv3::AsyncWatchAction::waitForResponse(
     if (ok == false) {
       break;
     }
+    if (got_tag == (void*) etcdv3::WATCH_WRITE_PROGRESS) {
+      this->OnProgressWritten();
+      continue;
+    }
     if (got_tag == (void*) etcdv3::WATCH_WRITE_CANCEL) {
       stream->WritesDone((void*) etcdv3::WATCH_WRITES_DONE);
       continue;
@@ -1459,6 +1491,11 @@ void etcdv3::AsyncWatchAction::waitForResponse(
             std::chrono::high_resolution_clock::now() - start_timepoint);
         callback(etcd::Response(resp, duration));
         start_timepoint = std::chrono::high_resolution_clock::now();
+      } else if (parameters.progress_notify && !reply.created()) {
+        // a progress notification, without events, the index of the response
+        // is the revision that the watch has reached
+        auto resp = ParseResponse();
+        callback(etcd::Response(resp, std::chrono::microseconds::zero()));
       }
       stream->Read(&reply, (void*) this);
       continue;
@@ -1468,19 +1505,64 @@ void etcdv3::AsyncWatchAction::waitForResponse(
       break;
     }
   }
+
+  std::lock_guard<std::mutex> scope_lock(write_mutex);
+  closed = true;
 }
 
 void etcdv3::AsyncWatchAction::CancelWatch() {
   if (!isCancelled.exchange(true)) {
-    WatchRequest cancel_req;
-    cancel_req.mutable_cancel_request()->set_watch_id(this->watch_id);
-    stream->Write(cancel_req, (void*) etcdv3::WATCH_WRITE_CANCEL);
+    std::lock_guard<std::mutex> scope_lock(write_mutex);
+    if (writing) {
+      // follows the progress request in flight
+      cancel_pending = true;
+    } else {
+      this->WriteCancelRequest();
+    }
     isCancelled.store(true);
   }
 }
 
 bool etcdv3::AsyncWatchAction::Cancelled() const { return isCancelled.load(); }
 
+void etcdv3::AsyncWatchAction::RequestProgress() {
+  std::lock_guard<std::mutex> scope_lock(write_mutex);
+  if (isCancelled.load() || closed) {
+    return;
+  }
+  if (writing) {
+    // the progress of the request in flight may predate the caller
+    progress_pending = true;
+  } else {
+    this->WriteProgressRequest();
+  }
+}
+
+void etcdv3::AsyncWatchAction::WriteProgressRequest() {
+  WatchRequest progress_req;
+  progress_req.mutable_progress_request();
+  writing = true;
+  progress_pending = false;
+  stream->Write(progress_req, (void*) etcdv3::WATCH_WRITE_PROGRESS);
+}
+
+void etcdv3::AsyncWatchAction::WriteCancelRequest() {
+  WatchRequest cancel_req;
+  cancel_req.mutable_cancel_request()->set_watch_id(this->watch_id);
+  stream->Write(cancel_req, (void*) etcdv3::WATCH_WRITE_CANCEL);
+}
+
+void etcdv3::AsyncWatchAction::OnProgressWritten() {
+  std::lock_guard<std::mutex> scope_lock(write_mutex);
+  writing = false;
+  if (cancel_pending) {
+    cancel_pending = false;
+    this->WriteCancelRequest();
+  } else if (progress_pending && !isCancelled.load()) {
+    this->WriteProgressRequest();
+  }
+}
+
 etcdv3::AsyncWatchResponse etcdv3::AsyncWatchAction::ParseResponse() {
   AsyncWatchResponse watch_resp;
   watch_resp.set_action(etcdv3::WATCH_ACTION);
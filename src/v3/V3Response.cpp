@@ -84,3 +84,10 @@ std::vector<int64_t> const& etcdv3::V3Response::get_leases() const {
 std::vector<etcdv3::Member> const& etcdv3::V3Response::get_members() const {
   return this->members;
 }
+
+std::vector<etcdv3::V3Response> const& etcdv3::V3Response::get_responses()
+    const {
+  return this->responses;
+}
+
+int64_t etcdv3::V3Response::get_count() const { return this->count; }
@@ -42,6 +42,7 @@ char const* etcdv3::KEEPALIVE_FINISH = "keepalive finish";
 char const* etcdv3::WATCH_CREATE = "watch create";
 char const* etcdv3::WATCH_WRITE = "watch write";
 char const* etcdv3::WATCH_WRITE_CANCEL = "watch write cancel";
+char const* etcdv3::WATCH_WRITE_PROGRESS = "watch write progress";
 char const* etcdv3::WATCH_WRITES_DONE = "watch writes done";
 char const* etcdv3::WATCH_FINISH = "watch finish";
 
@@ -0,0 +1,120 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "etcd/Batch.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("batch writer and reader") {
+  etcd::SyncClient etcd(etcd_url);
+
+  etcd::BatchWriter writer(etcd, 16);
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(i == static_cast<int>(writer.put("/test/batch/" + std::to_string(i),
+                                             std::to_string(i))));
+    REQUIRE(writer.inflight() <= 16);
+  }
+  std::vector<etcd::Response> written = writer.flush();
+  REQUIRE(written.size() == 100);
+  for (auto const& resp : written) {
+    REQUIRE(resp.is_ok());
+  }
+  REQUIRE(writer.inflight() == 0);
+  REQUIRE(writer.stats().completed == 100);
+  REQUIRE(writer.stats().failed == 0);
+
+  etcd::BatchReader reader(etcd, 16);
+  for (int i = 0; i < 101; ++i) {
+    reader.get("/test/batch/" + std::to_string(i));
+  }
+  std::vector<etcd::Response> read = reader.flush();
+  REQUIRE(read.size() == 101);
+  for (int i = 0; i < 100; ++i) {
+    REQUIRE(read[i].is_ok());
+    REQUIRE(std::to_string(i) == read[i].value().as_string());
+  }
+  REQUIRE(etcd::ERROR_KEY_NOT_FOUND == read[100].error_code());
+  REQUIRE(reader.stats().failed == 1);
+}
+
+TEST_CASE("batch writer keeps the order on the same key") {
+  etcd::SyncClient etcd(etcd_url);
+
+  etcd::BatchWriter writer(etcd, 32);
+  for (int i = 0; i < 50; ++i) {
+    writer.put("/test/batch/ordered", std::to_string(i));
+    writer.put("/test/batch/other-" + std::to_string(i), "value");
+  }
+  writer.rm("/test/batch/ordered");
+  writer.put("/test/batch/ordered", "last");
+  writer.flush();
+
+  etcd::Response resp = etcd.get("/test/batch/ordered");
+  REQUIRE(resp.is_ok());
+  REQUIRE("last" == resp.value().as_string());
+}
+
+TEST_CASE("batch writer reports to the callback") {
+  etcd::SyncClient etcd(etcd_url);
+
+  std::vector<size_t> indices;
+  {
+    etcd::BatchWriter writer(
+        etcd, 8, [&](size_t index, etcd::Response const& resp) {
+          REQUIRE(resp.is_ok());
+          indices.emplace_back(index);
+        });
+    for (int i = 0; i < 20; ++i) {
+      writer.put("/test/batch/callback-" + std::to_string(i), "value");
+    }
+    REQUIRE(writer.flush().empty());
+  }
+  REQUIRE(indices.size() == 20);
+  for (size_t i = 0; i < indices.size(); ++i) {
+    REQUIRE(i == indices[i]);
+  }
+}
+
+TEST_CASE("ingest throughput: put vs. batch writer") {
+  etcd::SyncClient etcd(etcd_url);
+  const int keys = 5000;
+
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < keys; ++i) {
+    REQUIRE(etcd.put("/test/batch/bench/" + std::to_string(i), "value")
+                .is_ok());
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::high_resolution_clock::now() - start);
+  std::cout << "SyncClient::put: " << keys * 1000000.0 / elapsed.count()
+            << " ops/s" << std::endl;
+
+  for (size_t window : {16, 64, 256}) {
+    etcd::BatchWriter writer(etcd, window);
+    for (int i = 0; i < keys; ++i) {
+      writer.put("/test/batch/bench/" + std::to_string(i), "value");
+    }
+    writer.flush();
+    REQUIRE(writer.stats().failed == 0);
+    std::cout << "BatchWriter (" << window
+              << " inflight): " << writer.stats().throughput() << " ops/s"
+              << std::endl;
+  }
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
@@ -0,0 +1,134 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "etcd/CoalescingWriter.hpp"
+#include "etcd/SyncClient.hpp"
+#include "etcd/v3/Transaction.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("responses of the operations in a txn") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(etcd.put("/test/coalesce/exists", "value").is_ok());
+
+  etcdv3::Transaction txn;
+  txn.add_success_put("/test/coalesce/new", "value", 0, true);
+  txn.add_success_range("/test/coalesce/exists");
+  txn.add_success_delete("/test/coalesce/missing", "", false, true);
+  etcd::Response resp = etcd.txn(txn);
+  REQUIRE(resp.is_ok());
+  REQUIRE(3 == resp.responses().size());
+
+  CHECK(etcdv3::PUT_ACTION == resp.responses()[0].action());
+  CHECK(resp.index() == resp.responses()[0].index());
+  CHECK(etcdv3::GET_ACTION == resp.responses()[1].action());
+  CHECK("value" == resp.responses()[1].value().as_string());
+  CHECK(etcdv3::DELETE_ACTION == resp.responses()[2].action());
+  CHECK(etcd::ERROR_KEY_NOT_FOUND == resp.responses()[2].error_code());
+}
+
+TEST_CASE("concurrent writes are coalesced") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::CoalescingWriter writer(etcd, std::chrono::milliseconds(20));
+
+  std::vector<std::future<etcd::Response>> futures;
+  for (int i = 0; i < 50; ++i) {
+    futures.emplace_back(
+        writer.put("/test/coalesce/" + std::to_string(i), std::to_string(i)));
+  }
+  for (auto& future : futures) {
+    etcd::Response resp = future.get();
+    REQUIRE(resp.is_ok());
+    CHECK(etcdv3::PUT_ACTION == resp.action());
+  }
+  CHECK(writer.operations() == 50);
+  CHECK(writer.transactions() < 50);
+
+  for (int i = 0; i < 50; ++i) {
+    etcd::Response resp = etcd.get("/test/coalesce/" + std::to_string(i));
+    REQUIRE(std::to_string(i) == resp.value().as_string());
+  }
+
+  // deletes report the missing keys
+  auto rm1 = writer.rm("/test/coalesce/0");
+  auto rm2 = writer.rm("/test/coalesce/not-exists");
+  writer.flush();
+  REQUIRE(rm1.get().is_ok());
+  REQUIRE(etcd::ERROR_KEY_NOT_FOUND == rm2.get().error_code());
+}
+
+TEST_CASE("writes on the same key are applied in order") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::CoalescingWriter writer(etcd, std::chrono::milliseconds(20), 8);
+
+  std::vector<std::future<etcd::Response>> futures;
+  for (int i = 0; i < 20; ++i) {
+    futures.emplace_back(writer.put("/test/coalesce/same", std::to_string(i)));
+  }
+  futures.emplace_back(writer.rm("/test/coalesce/same"));
+  futures.emplace_back(writer.put("/test/coalesce/same", "last"));
+  int64_t index = 0;
+  for (auto& future : futures) {
+    etcd::Response resp = future.get();
+    REQUIRE(resp.is_ok());
+    REQUIRE(resp.index() > index);
+    index = resp.index();
+  }
+  REQUIRE("last" == etcd.get("/test/coalesce/same").value().as_string());
+}
+
+TEST_CASE("write throughput: put vs. coalescing writer") {
+  etcd::SyncClient etcd(etcd_url);
+  const int threads = 16, rounds = 100;
+
+  using write_fn = std::function<etcd::Response(std::string const&)>;
+  auto bench = [&](std::string const& name, write_fn const& fn) {
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; ++t) {
+      workers.emplace_back([&, t]() {
+        for (int r = 0; r < rounds; ++r) {
+          REQUIRE(fn("/test/coalesce/bench/" + std::to_string(t) + "/" +
+                     std::to_string(r))
+                      .is_ok());
+        }
+      });
+    }
+    for (auto& worker : workers) {
+      worker.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start);
+    std::cout << name << ": " << threads * rounds << " writes in "
+              << elapsed.count() << "ms" << std::endl;
+  };
+
+  bench("SyncClient::put",
+        [&](std::string const& key) { return etcd.put(key, "value"); });
+
+  etcd::CoalescingWriter writer(etcd, std::chrono::microseconds(500));
+  bench("CoalescingWriter::put", [&](std::string const& key) {
+    return writer.put(key, "value").get();
+  });
+  std::cout << "  in " << writer.transactions() << " transactions"
+            << std::endl;
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
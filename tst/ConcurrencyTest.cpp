@@ -0,0 +1,290 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include "etcd/Concurrency.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("mutex lock and unlock") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::concurrency::Mutex mutex(etcd, "/test/mutex");
+
+  etcd::Response resp1 = mutex.lock();
+  CHECK("lock" == resp1.action());
+  REQUIRE(resp1.is_ok());
+  REQUIRE(mutex.key() == resp1.lock_key());
+  REQUIRE(etcd.get(mutex.key()).is_ok());
+
+  etcd::Response resp2 = mutex.unlock();
+  REQUIRE(resp2.is_ok());
+  REQUIRE(etcd.get(mutex.key()).error_code() == etcd::ERROR_KEY_NOT_FOUND);
+}
+
+TEST_CASE("mutex waits for the predecessor") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::concurrency::Mutex mutex1(etcd, "/test/mutex");
+  etcd::concurrency::Mutex mutex2(etcd, "/test/mutex");
+
+  REQUIRE(mutex1.lock().is_ok());
+
+  std::atomic_bool first_lock_release(false);
+  std::thread second_lock_thr([&]() {
+    etcd::Response resp = mutex2.lock();
+    REQUIRE(resp.is_ok());
+    // will success after first lock released.
+    REQUIRE(first_lock_release.load());
+    REQUIRE(mutex2.unlock().is_ok());
+  });
+
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  first_lock_release.store(true);
+  REQUIRE(mutex1.unlock().is_ok());
+  second_lock_thr.join();
+}
+
+TEST_CASE("mutex lock can be cancelled") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::concurrency::Mutex mutex1(etcd, "/test/mutex");
+  etcd::concurrency::Mutex mutex2(etcd, "/test/mutex");
+
+  REQUIRE(mutex1.lock().is_ok());
+
+  std::thread second_lock_thr([&]() {
+    etcd::Response resp = mutex2.lock();
+    REQUIRE(resp.error_code() == etcd::ERROR_ACTION_CANCELLED);
+  });
+
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  mutex2.cancel();
+  second_lock_thr.join();
+
+  // the cancelled contender has left the queue
+  REQUIRE(etcd.get(mutex2.key()).error_code() == etcd::ERROR_KEY_NOT_FOUND);
+  REQUIRE(mutex1.unlock().is_ok());
+}
+
+TEST_CASE("mutexes share a session lease") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::Response lease = etcd.leasegrant(60);
+  REQUIRE(lease.is_ok());
+
+  etcd::concurrency::Mutex mutex1(etcd, "/test/mutex-a", lease.value().lease());
+  etcd::concurrency::Mutex mutex2(etcd, "/test/mutex-b", lease.value().lease());
+  REQUIRE(mutex1.lock().is_ok());
+  REQUIRE(mutex2.lock().is_ok());
+  REQUIRE(etcd.get(mutex1.key()).value().lease() == lease.value().lease());
+
+  REQUIRE(etcd.leaserevoke(lease.value().lease()).is_ok());
+  REQUIRE(etcd.get(mutex1.key()).error_code() == etcd::ERROR_KEY_NOT_FOUND);
+  REQUIRE(etcd.get(mutex2.key()).error_code() == etcd::ERROR_KEY_NOT_FOUND);
+}
+
+TEST_CASE("election campaign, proclaim and resign") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::concurrency::Election election1(etcd, "/test/election");
+  etcd::concurrency::Election election2(etcd, "/test/election");
+
+  etcd::Response resp1 = election1.campaign("abc");
+  CHECK("campaign" == resp1.action());
+  REQUIRE(resp1.is_ok());
+
+  etcd::Response leader = election2.leader();
+  REQUIRE(leader.is_ok());
+  REQUIRE(leader.value().key() == election1.key());
+  REQUIRE(leader.value().as_string() == "abc");
+
+  REQUIRE(election1.proclaim("def").is_ok());
+  REQUIRE(election2.leader().value().as_string() == "def");
+
+  // not the leader
+  REQUIRE(!election2.proclaim("xyz").is_ok());
+
+  std::atomic_bool resigned(false);
+  std::thread campaign_thr([&]() {
+    etcd::Response resp = election2.campaign("xyz");
+    REQUIRE(resp.is_ok());
+    REQUIRE(resigned.load());
+  });
+
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  resigned.store(true);
+  REQUIRE(election1.resign().is_ok());
+  campaign_thr.join();
+
+  REQUIRE(election1.leader().value().as_string() == "xyz");
+  REQUIRE(election2.resign().is_ok());
+}
+
+TEST_CASE("readers of rwmutex proceed in parallel") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::concurrency::RWMutex reader1(etcd, "/test/rwmutex");
+  etcd::concurrency::RWMutex reader2(etcd, "/test/rwmutex");
+  etcd::concurrency::RWMutex writer(etcd, "/test/rwmutex");
+
+  REQUIRE(reader1.rlock().is_ok());
+  REQUIRE(reader2.rlock().is_ok());
+
+  std::atomic_bool readers_release(false);
+  std::thread writer_thr([&]() {
+    REQUIRE(writer.lock().is_ok());
+    // will success after all readers released.
+    REQUIRE(readers_release.load());
+
+    // readers wait for the writer
+    std::thread reader_thr([&]() {
+      REQUIRE(reader1.rlock().is_ok());
+      REQUIRE(reader1.runlock().is_ok());
+    });
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    REQUIRE(writer.unlock().is_ok());
+    reader_thr.join();
+  });
+
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  REQUIRE(reader1.runlock().is_ok());
+  readers_release.store(true);
+  REQUIRE(reader2.runlock().is_ok());
+  writer_thr.join();
+}
+
+TEST_CASE("semaphore admits at most capacity holders") {
+  etcd::SyncClient etcd(etcd_url);
+  const size_t capacity = 2, contenders = 6;
+
+  std::atomic<size_t> holding(0), max_holding(0);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < contenders; ++i) {
+    threads.emplace_back([&]() {
+      etcd::concurrency::Semaphore semaphore(etcd, "/test/semaphore", capacity);
+      REQUIRE(semaphore.acquire().is_ok());
+      size_t current = ++holding;
+      size_t expected = max_holding.load();
+      while (current > expected &&
+             !max_holding.compare_exchange_weak(expected, current)) {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      --holding;
+      REQUIRE(semaphore.release().is_ok());
+    });
+  }
+  for (auto& thr : threads) {
+    thr.join();
+  }
+  REQUIRE(max_holding.load() <= capacity);
+}
+
+static bool wait_until(std::function<bool()> const& done, int seconds) {
+  auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(seconds);
+  while (!done()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return true;
+}
+
+TEST_CASE("semaphore wakes the waiter behind a new holder") {
+  etcd::SyncClient etcd(etcd_url);
+  const std::string prefix = "/test/semaphore-handover";
+  const size_t capacity = 2;
+  auto contenders = [&]() { return etcd.keys(prefix).keys().size(); };
+
+  // h1 and h2 hold, p and s queue, h1 leaves and p acquires, then h2 leaves:
+  // s must acquire while p still holds. The later rounds move the release of
+  // h1 closer to the listing of s.
+  for (int round = 0; round < 4; ++round) {
+    etcd::concurrency::Semaphore h1(etcd, prefix, capacity);
+    etcd::concurrency::Semaphore h2(etcd, prefix, capacity);
+    etcd::concurrency::Semaphore p(etcd, prefix, capacity);
+    etcd::concurrency::Semaphore s(etcd, prefix, capacity);
+    REQUIRE(h1.acquire().is_ok());
+    REQUIRE(h2.acquire().is_ok());
+
+    std::atomic_bool p_acquired(false), s_acquired(false);
+    std::thread p_thr([&]() {
+      REQUIRE(p.acquire().is_ok());
+      p_acquired.store(true);
+    });
+    REQUIRE(wait_until([&]() { return contenders() == 3; }, 10));
+    std::thread s_thr([&]() { s_acquired.store(s.acquire().is_ok()); });
+    if (round < 2) {
+      REQUIRE(wait_until([&]() { return contenders() == 4; }, 10));
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+
+    REQUIRE(h1.release().is_ok());
+    REQUIRE(wait_until([&]() { return p_acquired.load(); }, 10));
+    CHECK(!s_acquired.load());
+    REQUIRE(h2.release().is_ok());
+    bool acquired = wait_until([&]() { return s_acquired.load(); }, 10);
+    if (!acquired) {
+      s.cancel();
+    }
+    s_thr.join();
+    p_thr.join();
+    CHECK(acquired);
+    REQUIRE(p.release().is_ok());
+    if (acquired) {
+      REQUIRE(s.release().is_ok());
+    }
+  }
+}
+
+TEST_CASE("lock contention: recipes vs. v3lock") {
+  etcd::SyncClient etcd(etcd_url);
+  const size_t threads = 8, rounds = 20;
+
+  auto bench = [&](std::string const& name,
+                   std::function<void(size_t)> const& worker) {
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i) {
+      workers.emplace_back(worker, i);
+    }
+    for (auto& thr : workers) {
+      thr.join();
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start);
+    std::cout << name << ": " << threads * rounds << " acquisitions in "
+              << elapsed.count() << "ms" << std::endl;
+  };
+
+  bench("SyncClient::lock", [&](size_t) {
+    for (size_t r = 0; r < rounds; ++r) {
+      etcd::Response resp = etcd.lock("/test/bench-v3lock");
+      REQUIRE(resp.is_ok());
+      REQUIRE(etcd.unlock(resp.lock_key()).is_ok());
+    }
+  });
+  bench("concurrency::Mutex", [&](size_t) {
+    etcd::concurrency::Mutex mutex(etcd, "/test/bench-mutex");
+    for (size_t r = 0; r < rounds; ++r) {
+      REQUIRE(mutex.lock().is_ok());
+      REQUIRE(mutex.unlock().is_ok());
+    }
+  });
+  bench("concurrency::RWMutex (3/4 readers)", [&](size_t i) {
+    etcd::concurrency::RWMutex mutex(etcd, "/test/bench-rwmutex");
+    for (size_t r = 0; r < rounds; ++r) {
+      if (i % 4 == 0) {
+        REQUIRE(mutex.lock().is_ok());
+        REQUIRE(mutex.unlock().is_ok());
+      } else {
+        REQUIRE(mutex.rlock().is_ok());
+        REQUIRE(mutex.runlock().is_ok());
+      }
+    }
+  });
+}
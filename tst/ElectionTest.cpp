@@ -1,9 +1,13 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
 
+#include <atomic>
 #include <chrono>
+#include <condition_variable>
 #include <iostream>
+#include <mutex>
 #include <thread>
+#include <vector>
 
 #include "etcd/Client.hpp"
 #include "etcd/KeepAlive.hpp"
@@ -109,6 +113,119 @@ TEST_CASE("campaign and observe") {
   observer_thread.join();
 }
 
+TEST_CASE("observe with callback") {
+  etcd::Client etcd(etcd_url);
+
+  auto keepalive = etcd.leasekeepalive(60).get();
+  auto lease_id = keepalive->Lease();
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::vector<std::string> leaders;
+  std::unique_ptr<etcd::Client::Observer> observer =
+      etcd.observe("test", [&](etcd::Response resp) {
+        REQUIRE(resp.is_ok());
+        std::lock_guard<std::mutex> scope_lock(mutex);
+        leaders.emplace_back(resp.value().as_string());
+        cv.notify_all();
+      });
+
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  for (int i = 0; i < 3; ++i) {
+    auto resp1 =
+        etcd.campaign("test", lease_id, "leader - " + std::to_string(i)).get();
+    REQUIRE(0 == resp1.error_code());
+    {
+      std::unique_lock<std::mutex> scope_lock(mutex);
+      REQUIRE(cv.wait_for(scope_lock, std::chrono::seconds(5), [&]() {
+        return !leaders.empty() &&
+               leaders.back() == "leader - " + std::to_string(i);
+      }));
+    }
+    auto resp2 = etcd.resign("test", lease_id, resp1.value().key(),
+                             resp1.value().created_index())
+                     .get();
+    REQUIRE(0 == resp2.error_code());
+  }
+
+  // no more callbacks after being cancelled
+  observer->Cancel();
+  size_t observed = leaders.size();
+  auto resp = etcd.campaign("test", lease_id, "after cancelled").get();
+  REQUIRE(0 == resp.error_code());
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  REQUIRE(observed == leaders.size());
+  REQUIRE(0 == etcd.resign("test", lease_id, resp.value().key(),
+                           resp.value().created_index())
+                   .get()
+                   .error_code());
+}
+
+TEST_CASE("cancel a pending campaign") {
+  etcd::Client etcd(etcd_url);
+
+  auto keepalive1 = etcd.leasekeepalive(60).get();
+  auto keepalive2 = etcd.leasekeepalive(60).get();
+
+  auto resp1 = etcd.campaign("test", keepalive1->Lease(), "leader").get();
+  REQUIRE(0 == resp1.error_code());
+
+  // the second one is blocked by the leader
+  pplx::cancellation_token_source cts;
+  auto task =
+      etcd.campaign("test", keepalive2->Lease(), "follower", cts.get_token());
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  REQUIRE(!task.is_done());
+
+  cts.cancel();
+  auto resp2 = task.get();
+  REQUIRE(!resp2.is_ok());
+  REQUIRE(etcdv3::ERROR_GRPC_CANCELLED == resp2.error_code());
+
+  // the leader is not affected
+  auto resp3 = etcd.leader("test").get();
+  REQUIRE(0 == resp3.error_code());
+  REQUIRE(resp1.value().key() == resp3.value().key());
+  REQUIRE(0 == etcd.resign("test", keepalive1->Lease(), resp1.value().key(),
+                           resp1.value().created_index())
+                   .get()
+                   .error_code());
+}
+
+TEST_CASE("many observers on one event loop") {
+  etcd::SyncClient etcd(etcd_url);
+
+  const size_t observers = 64;
+  std::atomic<size_t> notified(0);
+  std::vector<std::unique_ptr<etcd::SyncClient::Observer>> handles;
+  for (size_t i = 0; i < observers; ++i) {
+    handles.emplace_back(etcd.observe(
+        "test", [&](etcd::Response resp) {
+          if (resp.is_ok()) {
+            ++notified;
+          }
+        }));
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  auto keepalive = etcd.leasekeepalive(60);
+  auto resp = etcd.campaign("test", keepalive->Lease(), "value");
+  REQUIRE(resp.is_ok());
+
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (notified.load() < observers &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  REQUIRE(notified.load() >= observers);
+
+  handles.clear();
+  REQUIRE(etcd.resign("test", keepalive->Lease(), resp.value().key(),
+                      resp.value().created_index())
+              .is_ok());
+}
+
 TEST_CASE("cleanup") {
   etcd::Client etcd(etcd_url);
   etcd.rmdir("/test", true).get();
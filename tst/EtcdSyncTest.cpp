@@ -1,7 +1,11 @@
 #define CATCH_CONFIG_MAIN
 #include <catch.hpp>
+#include <atomic>
 #include <chrono>
+#include <iostream>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "etcd/SyncClient.hpp"
 
@@ -199,6 +203,238 @@ TEST_CASE("watch changes in the past") {
   REQUIRE(0 == etcd.rmdir("/test", true).error_code());
 }
 
+TEST_CASE("get many keys") {
+  etcd::SyncClient etcd(etcd_url);
+
+  std::vector<std::string> keys;
+  for (int i = 0; i < 300; ++i) {
+    keys.emplace_back("/test/many/" + std::to_string(i));
+    if (i % 3 != 0) {
+      REQUIRE(etcd.set(keys.back(), std::to_string(i)).is_ok());
+    }
+  }
+  keys.emplace_back("/test/many/1");  // duplicated
+
+  // split into 3 transactions
+  std::vector<etcd::Response> resps = etcd.get_many(keys, 128);
+  REQUIRE(keys.size() == resps.size());
+  for (int i = 0; i < 300; ++i) {
+    if (i % 3 != 0) {
+      REQUIRE(resps[i].is_ok());
+      CHECK("get" == resps[i].action());
+      CHECK(keys[i] == resps[i].value().key());
+      CHECK(std::to_string(i) == resps[i].value().as_string());
+    } else {
+      CHECK(etcd::ERROR_KEY_NOT_FOUND == resps[i].error_code());
+    }
+  }
+  CHECK("1" == resps[300].value().as_string());
+  CHECK(etcd.get_many({}).empty());
+
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
+
+TEST_CASE("coalesce identical concurrent reads") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(etcd.set("/test/hot", "42").is_ok());
+  REQUIRE(etcd.set("/test/hot2", "43").is_ok());
+
+  auto read_concurrently = [&](size_t threads) {
+    std::atomic_bool start(false);
+    std::vector<std::thread> readers;
+    for (size_t i = 0; i < threads; ++i) {
+      readers.emplace_back([&, i]() {
+        while (!start.load()) {
+          std::this_thread::yield();
+        }
+        if (i % 2 == 0) {
+          CHECK("42" == etcd.get("/test/hot").value().as_string());
+        } else {
+          CHECK(2 == etcd.ls("/test/hot").values().size());
+        }
+      });
+    }
+    start.store(true);
+    for (auto& reader : readers) {
+      reader.join();
+    }
+  };
+
+  // disabled by default
+  REQUIRE(!etcd.read_coalescing());
+  read_concurrently(64);
+  REQUIRE(0 == etcd.read_coalescing_hits());
+
+  etcd.set_read_coalescing(true);
+  read_concurrently(64);
+  std::cout << "coalesced reads: " << etcd.read_coalescing_hits() << std::endl;
+  CHECK(etcd.read_coalescing_hits() > 0);
+
+  // no stale results after the flights finished
+  REQUIRE(etcd.set("/test/hot", "44").is_ok());
+  REQUIRE("44" == etcd.get("/test/hot").value().as_string());
+
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
+
+TEST_CASE("serializable reads") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(etcd.set("/test/config/a", "1").is_ok());
+  REQUIRE(etcd.set("/test/config/b", "2").is_ok());
+
+  // per call
+  REQUIRE(etcd::ReadConsistency::LINEARIZABLE == etcd.get_read_consistency());
+  etcd::Response resp =
+      etcd.get("/test/config/a", etcd::ReadConsistency::SERIALIZABLE);
+  REQUIRE(resp.is_ok());
+  CHECK("1" == resp.value().as_string());
+  CHECK(etcd::ERROR_KEY_NOT_FOUND ==
+        etcd.get("/test/config/c", etcd::ReadConsistency::SERIALIZABLE)
+            .error_code());
+  auto serializable_read = etcd::ReadConsistency::SERIALIZABLE;
+  CHECK(2 == etcd.ls("/test/config", serializable_read).values().size());
+  CHECK(1 == etcd.ls("/test/config/a", "/test/config/b", serializable_read)
+                 .values()
+                 .size());
+  CHECK(2 == etcd.keys("/test/config", serializable_read).keys().size());
+  CHECK(2 == etcd.count("/test/config", serializable_read).count());
+
+  // per client
+  etcd.set_read_consistency(etcd::ReadConsistency::SERIALIZABLE);
+  CHECK("2" == etcd.get("/test/config/b").value().as_string());
+  CHECK(2 == etcd.ls("/test/config").values().size());
+  CHECK(2 == etcd.keys("/test/config").keys().size());
+
+  // latency of linearizable vs. serializable reads
+  auto measure = [&](etcd::ReadConsistency consistency) {
+    const int rounds = 1000;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < rounds; ++i) {
+      REQUIRE(etcd.get("/test/config/a", consistency).is_ok());
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::high_resolution_clock::now() - start)
+               .count() /
+           rounds;
+  };
+  auto linearizable = measure(etcd::ReadConsistency::LINEARIZABLE);
+  auto serializable = measure(etcd::ReadConsistency::SERIALIZABLE);
+  std::cout << "get latency: linearizable " << linearizable
+            << "us, serializable " << serializable << "us" << std::endl;
+
+  etcd.set_read_consistency(etcd::ReadConsistency::LINEARIZABLE);
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
+
+TEST_CASE("range options") {
+  etcd::SyncClient etcd(etcd_url);
+  int64_t base = etcd.set("/test/opts/a", "3").index();
+  REQUIRE(etcd.set("/test/opts/b", "1").is_ok());
+  REQUIRE(etcd.set("/test/opts/c", "2").is_ok());
+  int64_t changed = etcd.set("/test/opts/a", "4").index();
+
+  // the keys changed since the second put
+  etcd::RangeOptions since;
+  since.min_mod_revision = base + 2;
+  etcd::Response resp = etcd.ls("/test/opts/", since);
+  REQUIRE(resp.is_ok());
+  REQUIRE(2 == resp.keys().size());
+  CHECK("/test/opts/a" == resp.key(0));
+  CHECK("/test/opts/c" == resp.key(1));
+
+  // created before the last put, sorted by value in descending order
+  etcd::RangeOptions created;
+  created.max_create_revision = changed - 1;
+  created.min_create_revision = base + 1;
+  created.sort_target = etcd::RangeOptions::SortTarget::VALUE;
+  created.sort_order = etcd::RangeOptions::SortOrder::DESCEND;
+  resp = etcd.ls("/test/opts/", "/test/opts0", created);
+  REQUIRE(2 == resp.values().size());
+  CHECK("2" == resp.value(0).as_string());
+  CHECK("1" == resp.value(1).as_string());
+
+  // the latest modified key, keys only
+  etcd::RangeOptions latest;
+  latest.limit = 1;
+  latest.sort_target = etcd::RangeOptions::SortTarget::MOD;
+  latest.sort_order = etcd::RangeOptions::SortOrder::DESCEND;
+  resp = etcd.keys("/test/opts/", latest);
+  REQUIRE(1 == resp.keys().size());
+  CHECK("/test/opts/a" == resp.key(0));
+  CHECK(resp.value(0).as_string().empty());
+
+  // a filtered out key is not found
+  etcd::RangeOptions unchanged;
+  unchanged.max_mod_revision = base;
+  CHECK(etcd::ERROR_KEY_NOT_FOUND ==
+        etcd.get("/test/opts/a", unchanged).error_code());
+  unchanged.revision = base;
+  CHECK("3" == etcd.get("/test/opts/a", unchanged).value().as_string());
+
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
+
+TEST_CASE("count keys") {
+  etcd::SyncClient etcd(etcd_url);
+  for (int i = 0; i < 20; ++i) {
+    REQUIRE(etcd.set("/test/instances/" + std::to_string(i), "up").is_ok());
+  }
+
+  etcd::Response resp = etcd.count("/test/instances/");
+  REQUIRE(resp.is_ok());
+  CHECK(20 == resp.count());
+  CHECK(resp.keys().empty());
+  CHECK(resp.index() > 0);
+
+  // "/test/instances/1", "/test/instances/10" ... "/test/instances/19"
+  CHECK(11 == etcd.count("/test/instances/1", "/test/instances/2").count());
+  CHECK(0 == etcd.count("/test/nothing/").count());
+  CHECK(etcd.count("/test/nothing/").is_ok());
+
+  // the count of a listing is not bounded by the limit
+  CHECK(20 == etcd.ls("/test/instances/", 5).count());
+
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
+
+TEST_CASE("chunked directory removal") {
+  etcd::SyncClient etcd(etcd_url);
+  for (int i = 0; i < 250; ++i) {
+    REQUIRE(etcd.set("/test/chunked/" + std::to_string(i), "v").is_ok());
+  }
+  REQUIRE(etcd.set("/test/chunkedX", "outside").is_ok());
+
+  std::vector<int64_t> progress;
+  etcd::Response resp = etcd.rmdir_chunked(
+      "/test/chunked/", 100, false,
+      [&](int64_t deleted) { progress.emplace_back(deleted); });
+  REQUIRE(resp.is_ok());
+  CHECK(250 == resp.count());
+  CHECK(resp.values().empty());
+  CHECK(std::vector<int64_t>{100, 200, 250} == progress);
+  CHECK(0 == etcd.count("/test/chunked/").count());
+  CHECK(etcd.get("/test/chunkedX").is_ok());
+
+  // with the previous values, in a range
+  for (int i = 0; i < 10; ++i) {
+    REQUIRE(etcd.set("/test/chunked/" + std::to_string(i), "v").is_ok());
+  }
+  resp = etcd.rmdir_chunked("/test/chunked/", "/test/chunked/5", 3, true);
+  REQUIRE(resp.is_ok());
+  CHECK(5 == resp.count());  // 0 - 4
+  REQUIRE(5 == resp.values().size());
+  CHECK("/test/chunked/0" == resp.key(0));
+  CHECK("v" == resp.value(0).as_string());
+
+  CHECK(etcd::ERROR_KEY_NOT_FOUND ==
+        etcd.rmdir_chunked("/test/nothing/").error_code());
+
+  // the deleted count of a plain delete
+  CHECK(5 == etcd.rmdir("/test/chunked/", true).count());
+
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
+
 // TEST_CASE("request cancellation")
 // {
 //   etcd::Client etcd(etcd_url);
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <iostream>
 #include <thread>
+#include <vector>
 
 #include "etcd/Client.hpp"
 
@@ -548,6 +549,27 @@ TEST_CASE("watch multiple keys and use promise") {
   CHECK(2 == event_size);
 }
 
+TEST_CASE("coalesce identical async reads") {
+  etcd::Client etcd(etcd_url);
+  REQUIRE(etcd.set("/test/hot", "42").get().is_ok());
+  etcd.set_read_coalescing(true);
+
+  // the reads are issued without waiting, the identical ones join the
+  // in-flight read rather than waiting in a thread each
+  std::vector<pplx::task<etcd::Response>> reads;
+  for (size_t i = 0; i < 256; ++i) {
+    reads.emplace_back(etcd.get("/test/hot"));
+  }
+  for (auto& read : reads) {
+    CHECK("42" == read.get().value().as_string());
+  }
+  std::cout << "coalesced reads: " << etcd.read_coalescing_hits() << std::endl;
+  CHECK(etcd.read_coalescing_hits() > 0);
+
+  REQUIRE(etcd.set("/test/hot", "43").get().is_ok());
+  CHECK("43" == etcd.get("/test/hot").get().value().as_string());
+}
+
 TEST_CASE("lease grant") {
   etcd::Client etcd(etcd_url);
   etcd::Response res = etcd.leasegrant(60).get();
@@ -646,6 +668,53 @@ TEST_CASE("lease list") {
   }
 }
 
+TEST_CASE("lease batch operations") {
+  etcd::Client etcd(etcd_url);
+  std::vector<int> ttls;
+  for (int i = 0; i < 100; ++i) {
+    ttls.emplace_back(60 + i);
+  }
+
+  // a window smaller than the batch
+  std::vector<etcd::Response> granted = etcd.leasegrant_batch(ttls, 8).get();
+  REQUIRE(granted.size() == ttls.size());
+  std::vector<int64_t> lease_ids;
+  for (size_t i = 0; i < granted.size(); ++i) {
+    REQUIRE(granted[i].is_ok());
+    CHECK(ttls[i] == granted[i].value().ttl());
+    lease_ids.emplace_back(granted[i].value().lease());
+  }
+
+  std::vector<etcd::Response> ttlresps =
+      etcd.leasetimetolive_batch(lease_ids).get();
+  REQUIRE(ttlresps.size() == lease_ids.size());
+  for (size_t i = 0; i < ttlresps.size(); ++i) {
+    REQUIRE(ttlresps[i].is_ok());
+    CHECK(lease_ids[i] == ttlresps[i].value().lease());
+    CHECK(ttls[i] >= ttlresps[i].value().ttl());
+  }
+
+  std::vector<etcd::Response> listed = etcd.leases_with_ttl().get();
+  REQUIRE(!listed.empty());
+  if (listed.front().error_code() != etcdv3::ERROR_GRPC_UNIMPLEMENTED) {
+    REQUIRE(listed.size() >= lease_ids.size());
+    for (auto const& resp : listed) {
+      CHECK(resp.is_ok());
+    }
+  }
+
+  std::vector<etcd::Response> revoked =
+      etcd.leaserevoke_batch(lease_ids).get();
+  REQUIRE(revoked.size() == lease_ids.size());
+  for (auto const& resp : revoked) {
+    REQUIRE(resp.is_ok());
+  }
+  // revoked leases are gone
+  for (auto const& resp : etcd.leasetimetolive_batch(lease_ids).get()) {
+    CHECK(-1 == resp.value().ttl());
+  }
+}
+
 TEST_CASE("cleanup") {
   etcd::Client etcd(etcd_url);
   REQUIRE(0 == etcd.rmdir("/test", true).get().error_code());
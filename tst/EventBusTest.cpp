@@ -0,0 +1,126 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "etcd/EventBus.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+// collects the keys of the events, and the errors
+struct Collector {
+  std::mutex mutex;
+  std::vector<std::string> keys;
+  size_t errors = 0;
+
+  std::function<void(etcd::Response)> callback() {
+    return [this](etcd::Response resp) {
+      std::lock_guard<std::mutex> scope_lock(mutex);
+      if (!resp.is_ok()) {
+        errors += 1;
+      }
+      for (auto const& event : resp.events()) {
+        keys.emplace_back(event.kv().key());
+      }
+    };
+  }
+
+  std::vector<std::string> collected() {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    return keys;
+  }
+
+  size_t failed() {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    return errors;
+  }
+};
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("fan out by prefix") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::EventBus bus(etcd, "/test/bus/");
+  CHECK(nullptr == bus.subscribe("/test/other/", [](etcd::Response) {}));
+
+  Collector all, a, ab, b;
+  auto all_subscription = bus.subscribe("/test/bus/", all.callback());
+  auto a_subscription = bus.subscribe("/test/bus/a/", a.callback());
+  auto ab_subscription = bus.subscribe("/test/bus/a/b", ab.callback());
+  auto b_subscription = bus.subscribe("/test/bus/b/", b.callback());
+  REQUIRE(4 == bus.subscribers());
+
+  REQUIRE(etcd.set("/test/bus/a/1", "v1").is_ok());
+  REQUIRE(etcd.set("/test/bus/a/b", "v1").is_ok());
+  REQUIRE(etcd.set("/test/bus/b/1", "v1").is_ok());
+  REQUIRE(etcd.set("/test/bus/c/1", "v1").is_ok());
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  CHECK(4 == all.collected().size());
+  CHECK(std::vector<std::string>{"/test/bus/a/1", "/test/bus/a/b"} ==
+        a.collected());
+  CHECK(std::vector<std::string>{"/test/bus/a/b"} == ab.collected());
+  CHECK(std::vector<std::string>{"/test/bus/b/1"} == b.collected());
+
+  // unsubscribed
+  a_subscription.reset();
+  CHECK(3 == bus.subscribers());
+  REQUIRE(etcd.rm("/test/bus/a/b").is_ok());
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  CHECK(2 == a.collected().size());
+  CHECK(2 == ab.collected().size());
+  CHECK(5 == all.collected().size());
+  CHECK(0 == all.failed());
+}
+
+TEST_CASE("replay for late subscribers") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::EventBus bus(etcd, "/test/bus/", 16 /* revisions */);
+  int64_t const start = bus.revision();
+  CHECK(start + 1 == bus.history_revision());
+
+  for (int index = 0; index < 10; ++index) {
+    REQUIRE(etcd.set("/test/bus/replay/" + std::to_string(index), "v1")
+                .is_ok());
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  CHECK(start + 10 == bus.revision());
+
+  // replays the history, then continues with the live events
+  Collector late;
+  auto subscription =
+      bus.subscribe("/test/bus/replay/", late.callback(), start + 6);
+  REQUIRE(etcd.set("/test/bus/replay/10", "v1").is_ok());
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  std::vector<std::string> keys = late.collected();
+  REQUIRE(6 == keys.size());
+  CHECK("/test/bus/replay/5" == keys.front());
+  CHECK("/test/bus/replay/10" == keys.back());
+
+  // only the latest revisions are kept
+  for (int index = 0; index < 20; ++index) {
+    REQUIRE(etcd.set("/test/bus/replay/0", std::to_string(index)).is_ok());
+  }
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  CHECK(bus.revision() - 15 == bus.history_revision());
+  Collector too_late;
+  auto too_late_subscription =
+      bus.subscribe("/test/bus/replay/", too_late.callback(), start + 1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  CHECK(1 == too_late.failed());
+  CHECK(too_late.collected().empty());
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
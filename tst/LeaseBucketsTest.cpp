@@ -0,0 +1,112 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "etcd/LeaseBuckets.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("keys in the same window share a lease") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::LeaseBuckets buckets(etcd, std::chrono::seconds(60));
+
+  REQUIRE(buckets.put("/test/bucket/key1", "value1", 30).is_ok());
+  REQUIRE(buckets.put("/test/bucket/key2", "value2", 30).is_ok());
+  REQUIRE(buckets.add("/test/bucket/key3", "value3", 30).is_ok());
+  REQUIRE(buckets.size() == 1);
+
+  int64_t lease1 = etcd.get("/test/bucket/key1").value().lease();
+  REQUIRE(lease1 != 0);
+  REQUIRE(etcd.get("/test/bucket/key2").value().lease() == lease1);
+  REQUIRE(etcd.get("/test/bucket/key3").value().lease() == lease1);
+
+  // the lease lives at least as long as the requested ttl
+  etcd::Response ttl = etcd.leasetimetolive(lease1);
+  REQUIRE(ttl.is_ok());
+  REQUIRE(ttl.value().ttl() >= 29);
+  REQUIRE(ttl.value().ttl() <= 90);
+
+  // a far away expiration goes to another bucket
+  REQUIRE(buckets.put("/test/bucket/key4", "value4", 600).is_ok());
+  REQUIRE(buckets.size() == 2);
+  REQUIRE(etcd.get("/test/bucket/key4").value().lease() != lease1);
+
+  // add fails on an existing key
+  REQUIRE(!buckets.add("/test/bucket/key1", "value1", 30).is_ok());
+
+  REQUIRE(etcd.leaserevoke(lease1).is_ok());
+  REQUIRE(etcd.get("/test/bucket/key1").error_code() ==
+          etcd::ERROR_KEY_NOT_FOUND);
+}
+
+TEST_CASE("keys expire with the bucket") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::LeaseBuckets buckets(etcd, std::chrono::seconds(2));
+
+  REQUIRE(buckets.put("/test/bucket/expiring", "value", 1).is_ok());
+  REQUIRE(etcd.get("/test/bucket/expiring").is_ok());
+
+  // at most ttl + granularity, plus the lessor checkpoint
+  std::this_thread::sleep_for(std::chrono::seconds(5));
+  REQUIRE(etcd.get("/test/bucket/expiring").error_code() ==
+          etcd::ERROR_KEY_NOT_FOUND);
+  REQUIRE(buckets.size() == 0);
+}
+
+TEST_CASE("a revoked bucket is replaced") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::LeaseBuckets buckets(etcd, std::chrono::seconds(60));
+
+  REQUIRE(buckets.put("/test/bucket/key1", "value1", 30).is_ok());
+  int64_t lease1 = etcd.get("/test/bucket/key1").value().lease();
+  REQUIRE(etcd.leaserevoke(lease1).is_ok());
+
+  REQUIRE(buckets.put("/test/bucket/key2", "value2", 30).is_ok());
+  int64_t lease2 = etcd.get("/test/bucket/key2").value().lease();
+  REQUIRE(lease2 != lease1);
+  REQUIRE(etcd.leaserevoke(lease2).is_ok());
+}
+
+TEST_CASE("leases used by many keys") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::LeaseBuckets buckets(etcd, std::chrono::seconds(10));
+
+  const int keys = 1000;
+  std::set<int64_t> leases;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < keys; ++i) {
+    std::string key = "/test/bucket/many/" + std::to_string(i);
+    REQUIRE(buckets.put(key, "value", 60 + i % 120).is_ok());
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::high_resolution_clock::now() - start);
+  for (int i = 0; i < keys; ++i) {
+    leases.insert(
+        etcd.get("/test/bucket/many/" + std::to_string(i)).value().lease());
+  }
+  std::cout << keys << " keys with " << leases.size() << " leases in "
+            << elapsed.count() << "ms" << std::endl;
+  // 120 seconds of expirations spread over at most 13 windows
+  REQUIRE(leases.size() <= 13);
+
+  for (int64_t lease : leases) {
+    etcd.leaserevoke(lease);
+  }
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
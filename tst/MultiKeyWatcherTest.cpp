@@ -0,0 +1,228 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "etcd/MultiKeyWatcher.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+// collects the keys of the events
+struct Collector {
+  std::mutex mutex;
+  std::vector<std::string> keys;
+  size_t errors = 0;
+
+  void operator()(etcd::Response const& resp) {
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    if (!resp.is_ok()) {
+      errors += 1;
+    }
+    for (auto const& event : resp.events()) {
+      keys.emplace_back(event.kv().key());
+    }
+  }
+
+  std::vector<std::string> take() {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    std::lock_guard<std::mutex> scope_lock(mutex);
+    std::vector<std::string> taken;
+    taken.swap(keys);
+    return taken;
+  }
+};
+
+// discards the history up to the revision
+static bool compact(int64_t const revision) {
+  std::string cmd = "ETCDCTL_API=3 etcdctl --endpoints=" + etcd_url +
+                    " compact " + std::to_string(revision) + " > /dev/null";
+  return system(cmd.c_str()) == 0;
+}
+
+// waits until the replaced watches have been cancelled
+static bool retired(etcd::MultiKeyWatcher const& watcher) {
+  for (int attempt = 0; attempt < 50; ++attempt) {
+    if (watcher.replaced() == 0) {
+      return true;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  return false;
+}
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("merge keys into ranges") {
+  etcd::SyncClient etcd(etcd_url);
+  Collector collector;
+  etcd::MultiKeyWatcher watcher(
+      etcd, [&collector](etcd::Response resp) { collector(resp); });
+
+  std::vector<std::string> keys;
+  for (int index = 0; index < 100; ++index) {
+    keys.emplace_back("/test/mkw/" + std::to_string(index * 10 + 1000));
+  }
+  REQUIRE(watcher.add(keys, {}));
+  CHECK(100 == watcher.size());
+  CHECK(100 == watcher.watches());
+
+  // adjacent keys make a single range
+  REQUIRE(watcher.add(keys[0] + '\0'));
+  CHECK(100 == watcher.watches());
+
+  REQUIRE(etcd.set(keys[0], "v1").is_ok());
+  REQUIRE(etcd.set(keys[99], "v1").is_ok());
+  REQUIRE(etcd.set("/test/mkw/1001", "v1").is_ok());
+  std::vector<std::string> events = collector.take();
+  REQUIRE(2 == events.size());
+  CHECK(keys[0] == events[0]);
+  CHECK(keys[99] == events[1]);
+
+  // a range covers all keys
+  REQUIRE(watcher.add("/test/mkw/", "/test/mkw0"));
+  CHECK(1 == watcher.watches());
+  REQUIRE(etcd.set("/test/mkw/1001", "v2").is_ok());
+  events = collector.take();
+  REQUIRE(1 == events.size());
+  CHECK("/test/mkw/1001" == events[0]);
+
+  // the keys are still watched without the range
+  REQUIRE(watcher.remove("/test/mkw/", "/test/mkw0"));
+  CHECK(100 == watcher.watches());
+  REQUIRE(etcd.set("/test/mkw/1001", "v3").is_ok());
+  REQUIRE(etcd.set(keys[50], "v1").is_ok());
+  events = collector.take();
+  REQUIRE(1 == events.size());
+  CHECK(keys[50] == events[0]);
+
+  CHECK_FALSE(watcher.remove("/test/mkw/absent"));
+  for (auto const& key : keys) {
+    REQUIRE(watcher.remove(key));
+  }
+  REQUIRE(watcher.remove(keys[0] + '\0'));
+  CHECK(0 == watcher.size());
+  CHECK(0 == watcher.watches());
+  REQUIRE(etcd.set(keys[0], "v2").is_ok());
+  CHECK(collector.take().empty());
+
+  watcher.Cancel();
+  CHECK(watcher.Wait());
+}
+
+TEST_CASE("no events lost or duplicated when ranges change") {
+  etcd::SyncClient etcd(etcd_url);
+  Collector collector;
+  etcd::MultiKeyWatcher watcher(
+      etcd, {"/test/mkw/a", "/test/mkw/c"}, {},
+      [&collector](etcd::Response resp) { collector(resp); });
+  REQUIRE(2 == watcher.watches());
+
+  // writes while the watches are replaced
+  std::thread writer([&etcd]() {
+    for (int index = 0; index < 50; ++index) {
+      etcd.set("/test/mkw/a", std::to_string(index));
+      etcd.set("/test/mkw/c", std::to_string(index));
+    }
+  });
+  // bridges the two keys into a single range, and splits it again
+  std::string const after_a = std::string("/test/mkw/a") + '\0';
+  for (int round = 0; round < 10; ++round) {
+    REQUIRE(watcher.add("/test/mkw/b", "/test/mkw/c"));
+    REQUIRE(watcher.add(after_a, "/test/mkw/b"));
+    CHECK(1 == watcher.watches());
+    REQUIRE(watcher.remove("/test/mkw/b", "/test/mkw/c"));
+    REQUIRE(watcher.remove(after_a, "/test/mkw/b"));
+    CHECK(2 == watcher.watches());
+  }
+  writer.join();
+
+  std::vector<std::string> events = collector.take();
+  CHECK(100 == events.size());
+  CHECK(50 == std::count(events.begin(), events.end(), "/test/mkw/a"));
+  CHECK(50 == std::count(events.begin(), events.end(), "/test/mkw/c"));
+  CHECK(0 == collector.errors);
+}
+
+TEST_CASE("merge a quiet range after its revision is compacted") {
+  etcd::SyncClient etcd(etcd_url);
+  Collector collector;
+  etcd::MultiKeyWatcher watcher(
+      etcd, {}, {{"/test/mkw/q1", "/test/mkw/q2"}},
+      [&collector](etcd::Response resp) { collector(resp); });
+
+  // the range stays quiet while the history is compacted
+  int64_t revision = 0;
+  for (int index = 0; index < 10; ++index) {
+    revision = etcd.set("/test/mkw/other", std::to_string(index)).index();
+  }
+  REQUIRE(compact(revision));
+
+  // an adjacent range replaces the watch of the quiet one
+  REQUIRE(watcher.add("/test/mkw/q2", "/test/mkw/q3"));
+  CHECK(1 == watcher.watches());
+  REQUIRE(etcd.set("/test/mkw/q1", "v1").is_ok());
+  REQUIRE(etcd.set("/test/mkw/q2", "v1").is_ok());
+  std::vector<std::string> events = collector.take();
+  REQUIRE(2 == events.size());
+  CHECK("/test/mkw/q1" == events[0]);
+  CHECK("/test/mkw/q2" == events[1]);
+
+  // and so does splitting them again
+  REQUIRE(watcher.remove("/test/mkw/q2", "/test/mkw/q3"));
+  CHECK(1 == watcher.watches());
+  REQUIRE(etcd.set("/test/mkw/q1", "v2").is_ok());
+  REQUIRE(etcd.set("/test/mkw/q2", "v2").is_ok());
+  events = collector.take();
+  REQUIRE(1 == events.size());
+  CHECK("/test/mkw/q1" == events[0]);
+
+  CHECK(0 == collector.errors);
+  CHECK(!watcher.Stopped());
+}
+
+TEST_CASE("replaced watches are cancelled once the stream catches up") {
+  etcd::SyncClient etcd(etcd_url);
+  Collector collector;
+  etcd::MultiKeyWatcher watcher(
+      etcd, {"/test/mkw/r1"}, {},
+      [&collector](etcd::Response resp) { collector(resp); });
+
+  // the watch lags behind the revision it is replaced at, as the writes are
+  // outside of its range
+  for (int index = 0; index < 5; ++index) {
+    REQUIRE(etcd.set("/test/mkw/other", std::to_string(index)).is_ok());
+  }
+  std::string const after_r1 = std::string("/test/mkw/r1") + '\0';
+  REQUIRE(watcher.add(after_r1, "/test/mkw/r2"));
+  CHECK(1 == watcher.watches());
+  CHECK(retired(watcher));
+
+  for (int index = 0; index < 5; ++index) {
+    REQUIRE(etcd.set("/test/mkw/other", std::to_string(index)).is_ok());
+  }
+  REQUIRE(watcher.remove(after_r1, "/test/mkw/r2"));
+  CHECK(1 == watcher.watches());
+  CHECK(retired(watcher));
+
+  REQUIRE(etcd.set("/test/mkw/r1", "v1").is_ok());
+  std::vector<std::string> events = collector.take();
+  REQUIRE(1 == events.size());
+  CHECK("/test/mkw/r1" == events[0]);
+  CHECK(0 == collector.errors);
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
@@ -0,0 +1,81 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "etcd/NegativeCache.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("absent keys are answered locally") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::NegativeCache cache(etcd, "/test/flags/");
+  REQUIRE(etcd.set("/test/flags/on", "true").is_ok());
+
+  etcd::Response resp = cache.get("/test/flags/missing");
+  CHECK(etcd::ERROR_KEY_NOT_FOUND == resp.error_code());
+  CHECK(1 == cache.misses());
+  CHECK(cache.absent("/test/flags/missing"));
+
+  resp = cache.get("/test/flags/missing");
+  CHECK(etcd::ERROR_KEY_NOT_FOUND == resp.error_code());
+  CHECK(resp.index() > 0);
+  CHECK(1 == cache.hits());
+  CHECK(1 == cache.misses());
+
+  // keys that exist, or outside the prefix, are not remembered
+  resp = cache.get("/test/flags/on");
+  REQUIRE(resp.is_ok());
+  CHECK("true" == resp.value().as_string());
+  CHECK(etcd::ERROR_KEY_NOT_FOUND ==
+        cache.get("/test/other/missing").error_code());
+  CHECK(1 == cache.size());
+
+  // a put invalidates the key
+  int64_t revision = etcd.set("/test/flags/missing", "now").index();
+  for (int i = 0; i < 50 && cache.absent("/test/flags/missing"); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  CHECK(!cache.absent("/test/flags/missing"));
+  resp = cache.get("/test/flags/missing");
+  REQUIRE(resp.is_ok());
+  CHECK("now" == resp.value().as_string());
+  CHECK(revision == resp.value().modified_index());
+}
+
+TEST_CASE("bounded number of keys and bytes") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::NegativeCache cache(etcd, "/test/flags/", 10);
+  for (int i = 0; i < 20; ++i) {
+    cache.get("/test/flags/absent-" + std::to_string(i));
+  }
+  CHECK(10 == cache.size());
+  // the least recently used keys are evicted
+  CHECK(!cache.absent("/test/flags/absent-0"));
+  CHECK(cache.absent("/test/flags/absent-19"));
+
+  etcd::NegativeCache small(etcd, "/test/flags/", 1000, 1000);
+  for (int i = 0; i < 100; ++i) {
+    small.get("/test/flags/absent-" + std::to_string(i));
+  }
+  CHECK(small.bytes() <= 1000);
+  CHECK(small.size() < 100);
+
+  small.clear();
+  CHECK(0 == small.size());
+  CHECK(0 == small.bytes());
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
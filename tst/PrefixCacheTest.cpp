@@ -0,0 +1,262 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "etcd/PrefixCache.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+// discards the history up to the revision
+static bool compact(int64_t const revision) {
+  std::string cmd = "ETCDCTL_API=3 etcdctl --endpoints=" + etcd_url +
+                    " compact " + std::to_string(revision) + " > /dev/null";
+  return system(cmd.c_str()) == 0;
+}
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("mirror a prefix") {
+  etcd::SyncClient etcd(etcd_url);
+  for (int i = 0; i < 10; ++i) {
+    REQUIRE(etcd.set("/test/cache/" + std::to_string(i), std::to_string(i))
+                .is_ok());
+  }
+  REQUIRE(etcd.set("/test/cacheX", "outside").is_ok());
+
+  etcd::PrefixCache cache(etcd, "/test/cache/");
+  REQUIRE(cache.revision() > 0);
+  CHECK(10 == cache.size());
+
+  std::string value;
+  REQUIRE(cache.get("/test/cache/3", value));
+  CHECK("3" == value);
+  CHECK(!cache.get("/test/cacheX", value));
+
+  etcd::Response resp = cache.get("/test/cache/4");
+  REQUIRE(resp.is_ok());
+  CHECK("4" == resp.value().as_string());
+  CHECK(cache.revision() == resp.index());
+  CHECK(etcd::ERROR_KEY_NOT_FOUND == cache.get("/test/cache/a").error_code());
+
+  // changes are applied in order
+  REQUIRE(etcd.set("/test/cache/3", "33").is_ok());
+  REQUIRE(etcd.rm("/test/cache/4").is_ok());
+  int64_t revision = etcd.set("/test/cache/a", "new").index();
+  REQUIRE(cache.wait_for(revision, std::chrono::seconds(5)));
+  CHECK(revision == cache.revision());
+  REQUIRE(cache.get("/test/cache/3", value));
+  CHECK("33" == value);
+  CHECK(!cache.get("/test/cache/4", value));
+  REQUIRE(cache.get("/test/cache/a", value));
+  CHECK("new" == value);
+  CHECK(10 == cache.size());
+
+  resp = cache.ls("/test/cache/");
+  REQUIRE(10 == resp.keys().size());
+  CHECK("/test/cache/0" == resp.key(0));
+  CHECK("/test/cache/a" == resp.key(9));
+
+  // writes outside the prefix move the revision too
+  revision = etcd.set("/test/cacheX", "changed").index();
+  REQUIRE(cache.wait_for(revision, std::chrono::seconds(5)));
+  CHECK(revision == cache.revision());
+  CHECK(10 == cache.size());
+
+  CHECK(!cache.wait_for(revision + 100, std::chrono::milliseconds(100)));
+  CHECK(0 == cache.resyncs());
+}
+
+TEST_CASE("immutable snapshots") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::PrefixCache cache(etcd, "/test/snapshot/");
+  std::shared_ptr<const etcd::PrefixCache::Snapshot> empty = cache.snapshot();
+  CHECK(0 == empty->size());
+
+  // spans several chunks, which are split as they grow
+  int64_t revision = 0;
+  for (int i = 0; i < 600; ++i) {
+    char key[32];
+    snprintf(key, sizeof(key), "/test/snapshot/%04d", i);
+    revision = etcd.set(key, std::to_string(i)).index();
+  }
+  REQUIRE(cache.wait_for(revision, std::chrono::seconds(10)));
+  std::shared_ptr<const etcd::PrefixCache::Snapshot> full = cache.snapshot();
+  CHECK(0 == empty->size());
+  CHECK(600 == full->size());
+
+  for (int i = 0; i < 600; i += 2) {
+    char key[32];
+    snprintf(key, sizeof(key), "/test/snapshot/%04d", i);
+    revision = etcd.rm(key).index();
+  }
+  REQUIRE(cache.wait_for(revision, std::chrono::seconds(10)));
+  CHECK(300 == cache.size());
+
+  // the previous snapshot is unchanged
+  CHECK(600 == full->size());
+  std::string value;
+  CHECK(full->get("/test/snapshot/0100", value));
+  CHECK(!cache.get("/test/snapshot/0100", value));
+  REQUIRE(cache.get("/test/snapshot/0101", value));
+  CHECK("101" == value);
+
+  int index = 0;
+  for (auto const& entry : *full) {
+    char key[32];
+    snprintf(key, sizeof(key), "/test/snapshot/%04d", index++);
+    CHECK(key == entry.key());
+  }
+  CHECK(600 == index);
+
+  auto iter = full->lower_bound("/test/snapshot/0299x");
+  REQUIRE(iter != full->end());
+  CHECK("/test/snapshot/0300" == iter->key());
+  CHECK(300 == cache.ls("/test/snapshot/").keys().size());
+  CHECK(5 == cache.ls("/test/snapshot/020").keys().size());
+
+  // with the same semantics as SyncClient::ls(key, range_end)
+  etcd::Response resp =
+      cache.ls("/test/snapshot/0101", "/test/snapshot/0111");
+  REQUIRE(5 == resp.keys().size());
+  CHECK("/test/snapshot/0109" == resp.key(4));
+  CHECK(1 == cache.ls("/test/snapshot/0101", "").keys().size());
+  CHECK(0 == cache.ls("/test/snapshot/0100", "").keys().size());
+  resp = cache.ls("/test/snapshot/0589", std::string("\0", 1));
+  CHECK(6 == resp.keys().size());
+}
+
+TEST_CASE("warm start from a snapshot file") {
+  etcd::SyncClient etcd(etcd_url);
+  std::string const path = "/tmp/etcd-cpp-apiv3-prefix-cache.snapshot";
+  std::remove(path.c_str());
+
+  int64_t saved = 0;
+  {
+    etcd::PrefixCache cache(etcd, "/test/warm/", path);
+    int64_t revision = 0;
+    for (int i = 0; i < 100; ++i) {
+      char key[32];
+      snprintf(key, sizeof(key), "/test/warm/%04d", i);
+      revision = etcd.set(key, std::to_string(i)).index();
+    }
+    REQUIRE(cache.wait_for(revision, std::chrono::seconds(5)));
+    saved = cache.revision();
+  }
+
+  // resumes from the saved revision, and catches up with the changes since
+  {
+    etcd::PrefixCache cache(etcd, "/test/warm/", path);
+    CHECK(saved == cache.revision());
+    CHECK(100 == cache.size());
+    int64_t revision = etcd.set("/test/warm/0000", "changed").index();
+    REQUIRE(cache.wait_for(revision, std::chrono::seconds(5)));
+    std::string value;
+    REQUIRE(cache.get("/test/warm/0000", value));
+    CHECK("changed" == value);
+    REQUIRE(cache.get("/test/warm/0099", value));
+    CHECK("99" == value);
+    CHECK(0 == cache.resyncs());
+
+    // the snapshot of another prefix is not used, nor overwritten
+    CHECK(10 == etcd::PrefixCache(etcd, "/test/warm/005", path).size());
+    saved = cache.revision();
+  }
+  // loading the prefix would see the revision of this write
+  REQUIRE(etcd.set("/test/warmX", "outside").index() > saved);
+  {
+    etcd::PrefixCache cache(etcd, "/test/warm/", path);
+    CHECK(saved == cache.revision());
+    CHECK(0 == cache.resyncs());
+  }
+
+  // nor a snapshot whose revision has been compacted
+  etcd.set("/test/warm/0001", "changed");
+  int64_t revision = etcd.set("/test/warm/0002", "changed").index();
+  REQUIRE(compact(revision));
+  {
+    etcd::PrefixCache cache(etcd, "/test/warm/", path);
+    REQUIRE(cache.wait_for(revision, std::chrono::seconds(5)));
+    for (int i = 0; i < 50 && cache.resyncs() == 0; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    CHECK(1 == cache.resyncs());
+    CHECK(100 == cache.size());
+    std::string value;
+    REQUIRE(cache.get("/test/warm/0002", value));
+    CHECK("changed" == value);
+  }
+
+  // nor an invalid one
+  {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    out << "not a snapshot";
+  }
+  {
+    etcd::PrefixCache cache(etcd, "/test/warm/", path);
+    CHECK(100 == cache.size());
+    CHECK(revision <= cache.revision());
+  }
+  std::remove(path.c_str());
+}
+
+TEST_CASE("local reads") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::PrefixCache cache(etcd, "/test/cache/");
+
+  const int rounds = 1000000;
+  std::string value;
+  auto start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < rounds; ++i) {
+    cache.get("/test/cache/" + std::to_string(i % 10), value);
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::high_resolution_clock::now() - start);
+  std::cout << "cached get: " << elapsed.count() / rounds << "ns" << std::endl;
+
+  // readers don't contend with each other
+  size_t concurrency = std::max(std::thread::hardware_concurrency(), 1u);
+  std::vector<std::thread> readers;
+  start = std::chrono::high_resolution_clock::now();
+  for (size_t index = 0; index < concurrency; ++index) {
+    readers.emplace_back([&cache, rounds]() {
+      std::string value;
+      for (int i = 0; i < rounds; ++i) {
+        cache.get("/test/cache/" + std::to_string(i % 10), value);
+      }
+    });
+  }
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::high_resolution_clock::now() - start);
+  std::cout << "cached get with " << concurrency
+            << " threads: " << elapsed.count() / rounds << "ns" << std::endl;
+
+  start = std::chrono::high_resolution_clock::now();
+  for (int i = 0; i < 1000; ++i) {
+    etcd.get("/test/cache/" + std::to_string(i % 10));
+  }
+  elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::high_resolution_clock::now() - start);
+  std::cout << "remote get: " << elapsed.count() / 1000 << "ns" << std::endl;
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
@@ -0,0 +1,136 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "etcd/RadixTree.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("radix tree follows the order of etcd") {
+  etcd::SyncClient etcd(etcd_url);
+  // hierarchical keys, with shared prefixes of different lengths
+  std::mt19937 random(42);
+  for (int i = 0; i < 500; ++i) {
+    std::string key = "/test/radix/service-" + std::to_string(random() % 7) +
+                      "/instances/" + std::to_string(random() % 97);
+    if (random() % 3 == 0) {
+      key += "/port";
+    }
+    REQUIRE(etcd.put(key, std::to_string(i)).is_ok());
+  }
+  etcd::Response resp = etcd.ls("/test/radix/");
+  REQUIRE(resp.is_ok());
+
+  etcd::RadixTree tree;
+  std::map<std::string, etcd::Value> expected;
+  for (auto const& value : resp.values()) {
+    CHECK(tree.insert(value));
+    expected.emplace(value.key(), value);
+  }
+  CHECK(!tree.insert(resp.values()[0]));
+  REQUIRE(expected.size() == tree.size());
+
+  auto iter = tree.begin();
+  for (auto const& item : expected) {
+    REQUIRE(iter != tree.end());
+    CHECK(item.first == iter->key());
+    CHECK(item.second.as_string() == iter->as_string());
+    ++iter;
+  }
+  CHECK(iter == tree.end());
+
+  // removes half of the keys, in random order
+  std::vector<std::string> keys;
+  for (auto const& item : expected) {
+    keys.emplace_back(item.first);
+  }
+  std::shuffle(keys.begin(), keys.end(), random);
+  for (size_t index = 0; index < keys.size() / 2; ++index) {
+    CHECK(tree.erase(keys[index]));
+    CHECK(!tree.erase(keys[index]));
+    expected.erase(keys[index]);
+  }
+  REQUIRE(expected.size() == tree.size());
+  for (auto const& key : keys) {
+    etcd::Value value = resp.values()[0];
+    auto item = expected.find(key);
+    if (item == expected.end()) {
+      CHECK(!tree.find(key, value));
+      CHECK(!tree.contains(key));
+    } else {
+      REQUIRE(tree.find(key, value));
+      CHECK(key == value.key());
+      CHECK(item->second.as_string() == value.as_string());
+      CHECK(item->second.modified_index() == value.modified_index());
+      std::string bytes;
+      REQUIRE(tree.get(key, bytes));
+      CHECK(item->second.as_string() == bytes);
+    }
+  }
+
+  // replaces the values, with shorter and longer ones
+  for (auto const& item : expected) {
+    std::string const& previous = item.second.as_string();
+    std::string const next =
+        previous.size() % 2 == 0 ? "" : previous + previous;
+    REQUIRE(etcd.put(item.first, next).is_ok());
+  }
+  resp = etcd.ls("/test/radix/");
+  REQUIRE(resp.is_ok());
+  for (auto const& value : resp.values()) {
+    auto item = expected.find(value.key());
+    if (item != expected.end()) {
+      CHECK(!tree.insert(value));
+      item->second = value;
+    }
+  }
+  REQUIRE(expected.size() == tree.size());
+  iter = tree.begin();
+  for (auto const& item : expected) {
+    REQUIRE(iter != tree.end());
+    CHECK(item.first == iter->key());
+    CHECK(item.second.as_string() == iter->as_string());
+    CHECK(item.second.modified_index() == iter->modified_index());
+    ++iter;
+  }
+  CHECK(iter == tree.end());
+
+  // lower bounds, of keys that exist, and keys in between
+  for (auto const& key :
+       {std::string(""), std::string("/test/radix/service-3"),
+        std::string("/test/radix/service-3/instances/5"),
+        std::string("/test/radix/service-3/instances/50/portx"),
+        std::string("/test/radix/service-9"), keys[0], keys.back()}) {
+    auto lower = tree.lower_bound(key);
+    auto item = expected.lower_bound(key);
+    if (item == expected.end()) {
+      CHECK(lower == tree.end());
+    } else {
+      REQUIRE(lower != tree.end());
+      CHECK(item->first == lower->key());
+    }
+  }
+
+  for (auto const& key : keys) {
+    tree.erase(key);
+  }
+  CHECK(tree.empty());
+  CHECK(tree.begin() == tree.end());
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
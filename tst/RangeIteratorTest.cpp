@@ -0,0 +1,175 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "etcd/RangeIterator.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+static std::string padded(int i) {
+  std::string s = std::to_string(i);
+  return std::string(6 - s.size(), '0') + s;
+}
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("iterate a prefix page by page") {
+  etcd::SyncClient etcd(etcd_url);
+  for (int i = 0; i < 250; ++i) {
+    REQUIRE(etcd.set("/test/range/" + padded(i), std::to_string(i)).is_ok());
+  }
+  REQUIRE(etcd.set("/test/rangeX", "outside").is_ok());
+
+  etcd::RangeIterator iter(etcd, "/test/range/", 100);
+  int expected = 0, pages = 0;
+  while (iter.has_next()) {
+    etcd::Response page = iter.next();
+    REQUIRE(page.is_ok());
+    pages += 1;
+    for (auto const& value : page.values()) {
+      CHECK("/test/range/" + padded(expected) == value.key());
+      CHECK(std::to_string(expected) == value.as_string());
+      expected += 1;
+    }
+  }
+  CHECK(250 == expected);
+  CHECK(3 == pages);
+  CHECK(250 == iter.count());
+  CHECK(iter.revision() > 0);
+  CHECK(iter.next().values().empty());
+}
+
+TEST_CASE("pages are read at a pinned revision") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::RangeIterator iter(etcd, "/test/range/", 50, true);
+
+  etcd::Response first = iter.next();
+  REQUIRE(first.is_ok());
+  REQUIRE(50 == first.keys().size());
+  CHECK(first.values()[0].as_string().empty());
+
+  // changes after the first page are not visible
+  REQUIRE(etcd.rm("/test/range/" + padded(200)).is_ok());
+  REQUIRE(etcd.set("/test/range/" + padded(300), "new").is_ok());
+
+  size_t total = first.keys().size();
+  while (iter.has_next()) {
+    etcd::Response page = iter.next();
+    REQUIRE(page.is_ok());
+    CHECK(iter.revision() == first.index());
+    total += page.keys().size();
+  }
+  CHECK(250 == total);
+}
+
+TEST_CASE("iterate an explicit range") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::RangeIterator iter(etcd, "/test/range/" + padded(10),
+                           "/test/range/" + padded(20), 3);
+  size_t total = 0;
+  while (iter.has_next()) {
+    total += iter.next().values().size();
+  }
+  CHECK(10 == total);
+
+  etcd::RangeIterator empty(etcd, "/test/nothing/", 10);
+  etcd::Response page = empty.next();
+  CHECK(page.is_ok());
+  CHECK(page.values().empty());
+  CHECK(!empty.has_next());
+}
+
+TEST_CASE("scan a large prefix") {
+  etcd::SyncClient etcd(etcd_url);
+  const int keys = 5000;
+  for (int i = 0; i < keys; ++i) {
+    etcd.set("/test/large/" + padded(i), std::string(100, 'x'));
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  etcd::RangeIterator iter(etcd, "/test/large/", 500);
+  while (iter.has_next()) {
+    REQUIRE(iter.next().is_ok());
+  }
+  auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::high_resolution_clock::now() - start);
+  std::cout << "iterated " << iter.count() << " keys in " << elapsed.count()
+            << "ms" << std::endl;
+  CHECK(keys == iter.count());
+}
+
+TEST_CASE("parallel scan in key order") {
+  etcd::SyncClient etcd(etcd_url);
+  for (int i = 0; i < 300; ++i) {
+    REQUIRE(etcd.set("/test/scan/" + std::string(1, 'a' + i % 26) + padded(i),
+                     std::to_string(i))
+                .is_ok());
+  }
+
+  etcd::ParallelScan scan(etcd, "/test/scan/", 4, 20);
+  std::vector<std::string> keys;
+  etcd::Response resp = scan.scan([&](etcd::Response const& page) {
+    for (auto const& value : page.values()) {
+      keys.emplace_back(value.key());
+    }
+  });
+  REQUIRE(resp.is_ok());
+  CHECK(3 == scan.splits().size());
+  CHECK(scan.revision() > 0);
+  CHECK(300 == scan.count());
+  REQUIRE(300 == keys.size());
+  CHECK(std::is_sorted(keys.begin(), keys.end()));
+  CHECK(std::unique(keys.begin(), keys.end()) == keys.end());
+}
+
+TEST_CASE("parallel scan with caller splits, unordered") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::ParallelScan scan(etcd, "/test/scan/", "/test/scan0",
+                          {"/test/scan/h", "/test/scan/p", "/test/zzz"}, 7,
+                          true);
+  // the split outside of the range is dropped
+  CHECK(2 == scan.splits().size());
+
+  std::vector<std::string> keys;
+  REQUIRE(scan.scan(
+                  [&](etcd::Response const& page) {
+                    for (auto const& key : page.keys()) {
+                      keys.emplace_back(key);
+                    }
+                  },
+                  false)
+              .is_ok());
+  CHECK(300 == keys.size());
+  std::sort(keys.begin(), keys.end());
+  CHECK(std::unique(keys.begin(), keys.end()) == keys.end());
+}
+
+TEST_CASE("parallel scan of a large prefix") {
+  etcd::SyncClient etcd(etcd_url);
+  for (size_t partitions : {1, 8}) {
+    auto start = std::chrono::high_resolution_clock::now();
+    etcd::ParallelScan scan(etcd, "/test/large/", partitions, 250);
+    REQUIRE(scan.scan([](etcd::Response const&) {}).is_ok());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::high_resolution_clock::now() - start);
+    std::cout << "scanned " << scan.count() << " keys with "
+              << scan.splits().size() + 1 << " sub-ranges in "
+              << elapsed.count() << "ms" << std::endl;
+    CHECK(5000 == scan.count());
+  }
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
@@ -0,0 +1,91 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include "etcd/ReadThroughCache.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("stale while revalidate") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::ReadThroughCache cache(etcd, std::chrono::milliseconds(500));
+  REQUIRE(etcd.set("/test/rtc/key", "v1").is_ok());
+
+  etcd::Response resp = cache.get("/test/rtc/key");
+  REQUIRE(resp.is_ok());
+  CHECK("v1" == resp.value().as_string());
+  CHECK(1 == cache.misses());
+  CHECK("v1" == cache.get("/test/rtc/key").value().as_string());
+  CHECK(1 == cache.hits());
+
+  // absent keys are not cached
+  resp = cache.get("/test/rtc/absent");
+  CHECK(etcd::ERROR_KEY_NOT_FOUND == resp.error_code());
+  CHECK(1 == cache.size());
+
+  // the expired value is served, while revalidated in the background
+  REQUIRE(etcd.set("/test/rtc/key", "v2").is_ok());
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  CHECK("v1" == cache.get("/test/rtc/key").value().as_string());
+  CHECK(1 == cache.stale_hits());
+  for (int i = 0; i < 50 && cache.revalidations() == 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  CHECK("v2" == cache.get("/test/rtc/key").value().as_string());
+  CHECK(2 == cache.hits());
+
+  // a deleted key is evicted by the revalidation
+  REQUIRE(etcd.rm("/test/rtc/key").is_ok());
+  std::this_thread::sleep_for(std::chrono::milliseconds(600));
+  cache.get("/test/rtc/key");
+  for (int i = 0; i < 50 && cache.size() != 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  CHECK(0 == cache.size());
+  CHECK(etcd::ERROR_KEY_NOT_FOUND == cache.get("/test/rtc/key").error_code());
+}
+
+TEST_CASE("invalidate by watch") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::ReadThroughCache cache(etcd, std::chrono::seconds(3600),
+                               etcd::ReadThroughCache::DEFAULT_MAX_BYTES,
+                               "/test/rtc/");
+  REQUIRE(etcd.set("/test/rtc/watched", "v1").is_ok());
+  CHECK("v1" == cache.get("/test/rtc/watched").value().as_string());
+  REQUIRE(etcd.set("/test/rtc/watched", "v2").is_ok());
+  for (int i = 0; i < 50 && cache.size() != 0; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  CHECK("v2" == cache.get("/test/rtc/watched").value().as_string());
+}
+
+TEST_CASE("bounded memory") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::ReadThroughCache cache(etcd, std::chrono::seconds(3600), 4096);
+  std::string value(256, 'x');
+  for (int i = 0; i < 50; ++i) {
+    std::string key = "/test/rtc/large-" + std::to_string(i);
+    REQUIRE(etcd.set(key, value).is_ok());
+    REQUIRE(cache.get(key).is_ok());
+  }
+  CHECK(cache.bytes() <= 4096);
+  CHECK(cache.size() < 50);
+  // the most recently used keys are kept
+  cache.get("/test/rtc/large-49");
+  CHECK(cache.hits() >= 1);
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
@@ -0,0 +1,74 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+
+#include "etcd/Session.hpp"
+#include "etcd/SyncClient.hpp"
+#include "etcd/v3/Transaction.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("read your writes") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::Session session(etcd);
+  CHECK(0 == session.revision());
+
+  etcd::Response resp = session.set("/test/session/key", "v1");
+  REQUIRE(resp.is_ok());
+  CHECK(resp.index() == session.revision());
+  resp = session.get("/test/session/key");
+  REQUIRE(resp.is_ok());
+  CHECK("v1" == resp.value().as_string());
+  CHECK(resp.index() >= session.revision());
+
+  REQUIRE(session.put("/test/session/key", "v2").is_ok());
+  REQUIRE(session.add("/test/session/other", "v1").is_ok());
+  CHECK("v2" == session.get("/test/session/key").value().as_string());
+  resp = session.ls("/test/session/");
+  REQUIRE(resp.is_ok());
+  CHECK(2 == resp.keys().size());
+  resp = session.ls("/test/session/key", "/test/session/key0");
+  REQUIRE(resp.is_ok());
+  CHECK(1 == resp.keys().size());
+
+  etcdv3::Transaction txn;
+  txn.add_success_put("/test/session/key", "v3");
+  resp = session.txn(txn);
+  REQUIRE(resp.is_ok());
+  CHECK(resp.index() == session.revision());
+  CHECK("v3" == session.get("/test/session/key").value().as_string());
+
+  REQUIRE(session.rm("/test/session/key").is_ok());
+  CHECK(etcd::ERROR_KEY_NOT_FOUND ==
+        session.get("/test/session/key").error_code());
+
+  // a single member never lags behind itself
+  CHECK(0 == session.retries());
+  CHECK(0 == session.fallbacks());
+}
+
+TEST_CASE("observe writes made elsewhere") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd::Session session(etcd);
+  etcd::Response resp = etcd.set("/test/session/elsewhere", "v1");
+  REQUIRE(resp.is_ok());
+  session.observe(resp);
+  CHECK(resp.index() == session.revision());
+
+  // never goes backwards
+  session.observe(etcd::Response());
+  CHECK(resp.index() == session.revision());
+  CHECK("v1" == session.get("/test/session/elsewhere").value().as_string());
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}
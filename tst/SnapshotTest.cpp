@@ -0,0 +1,91 @@
+#define CATCH_CONFIG_MAIN
+#include <catch.hpp>
+
+#include <string>
+#include <vector>
+
+#include "etcd/Snapshot.hpp"
+#include "etcd/SyncClient.hpp"
+
+static const std::string etcd_url =
+    etcdv3::detail::resolve_etcd_endpoints("http://127.0.0.1:2379");
+
+TEST_CASE("setup") {
+  etcd::SyncClient etcd(etcd_url);
+  etcd.rmdir("/test", true);
+}
+
+TEST_CASE("pinned by the first read") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(etcd.set("/test/snapshot/a", "a1").is_ok());
+  REQUIRE(etcd.set("/test/snapshot/b", "b1").is_ok());
+
+  etcd::Snapshot snapshot(etcd);
+  CHECK(0 == snapshot.revision());
+  etcd::Response resp = snapshot.get("/test/snapshot/a");
+  REQUIRE(resp.is_ok());
+  CHECK("a1" == resp.value().as_string());
+  int64_t revision = snapshot.revision();
+  CHECK(resp.index() == revision);
+
+  // later writes are not observed
+  REQUIRE(etcd.set("/test/snapshot/b", "b2").is_ok());
+  REQUIRE(etcd.set("/test/snapshot/c", "c1").is_ok());
+  resp = snapshot.get("/test/snapshot/b");
+  REQUIRE(resp.is_ok());
+  CHECK("b1" == resp.value().as_string());
+  CHECK(etcd::ERROR_KEY_NOT_FOUND ==
+        snapshot.get("/test/snapshot/c").error_code());
+
+  resp = snapshot.ls("/test/snapshot/");
+  REQUIRE(resp.is_ok());
+  REQUIRE(2 == resp.keys().size());
+  CHECK("b1" == resp.value(1).as_string());
+  resp = snapshot.ls("/test/snapshot/b", "/test/snapshot/d");
+  REQUIRE(resp.is_ok());
+  CHECK(1 == resp.keys().size());
+  CHECK(revision == snapshot.revision());
+}
+
+TEST_CASE("batch of keys") {
+  etcd::SyncClient etcd(etcd_url);
+  std::vector<std::string> keys;
+  for (int index = 0; index < 20; ++index) {
+    keys.emplace_back("/test/snapshot/batch/" + std::to_string(index));
+    REQUIRE(etcd.set(keys.back(), "v1").is_ok());
+  }
+  keys.emplace_back("/test/snapshot/batch/absent");
+
+  // pinned by a head()
+  etcd::Snapshot snapshot(etcd);
+  std::vector<etcd::Response> responses = snapshot.get(keys);
+  int64_t revision = snapshot.revision();
+  CHECK(revision > 0);
+  REQUIRE(keys.size() == responses.size());
+  for (size_t index = 0; index + 1 < keys.size(); ++index) {
+    REQUIRE(responses[index].is_ok());
+    CHECK(keys[index] == responses[index].value().key());
+  }
+  CHECK(etcd::ERROR_KEY_NOT_FOUND == responses.back().error_code());
+
+  for (size_t index = 0; index + 1 < keys.size(); ++index) {
+    REQUIRE(etcd.set(keys[index], "v2").is_ok());
+  }
+  for (auto const& resp : snapshot.get(keys)) {
+    if (resp.is_ok()) {
+      CHECK("v1" == resp.value().as_string());
+    }
+  }
+  CHECK(revision == snapshot.revision());
+
+  // pinned by the caller
+  etcd::Snapshot pinned(etcd, revision);
+  CHECK("v1" == pinned.get(keys[0]).value().as_string());
+  etcd::Snapshot latest(etcd);
+  CHECK("v2" == latest.get(keys[0]).value().as_string());
+}
+
+TEST_CASE("cleanup") {
+  etcd::SyncClient etcd(etcd_url);
+  REQUIRE(0 == etcd.rmdir("/test", true).error_code());
+}